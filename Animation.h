@@ -20,4 +20,15 @@ class Animation {
      *  @return true if animation is done
      */
     virtual bool run(float progress, MatrixManager *mm) = 0;
+
+    /**
+     * Identify the frames of a deterministic animation, so they can be pre-rendered once
+     * and replayed from the AnimationCache. Two animations with the same key must draw
+     * the same frames for the same progress, duration and matrix size.
+     * @return key of the animation, 0 if it can't be cached
+     */
+    virtual unsigned long long cache_key() const
+    {
+        return 0;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,248 @@
+#pragma once
+#include "Animation.h"
+#include "FrameCodec.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * The frames of a pre-rendered animation. Frame i shows the animation i / fps seconds
+ * after its start. The frames are stored one after another as a FrameEncoder stream,
+ * so they can only be decoded in order.
+ */
+struct AnimationClip
+{
+    int fps = 0;
+    int pixel_count = 0;
+    // encoded frames, frame i starts at offsets[i]
+    std::vector<uint8_t> data;
+    std::vector<uint32_t> offsets;
+    // the animation reported to be done at this frame
+    std::vector<bool> done;
+    unsigned long long last_used = 0;
+
+    int frame_count() const
+    {
+        return static_cast<int>(offsets.size());
+    }
+
+    size_t memory() const
+    {
+        return data.size() + offsets.size() * sizeof(uint32_t) + done.size() / 8 + sizeof(AnimationClip);
+    }
+};
+
+/**
+ * Replays an AnimationClip onto the active layer. The clip only matches the animation at
+ * its frame times, so playback has to start with a frame, see Timeline::step.
+ */
+class ClipPlayer
+{
+public:
+    explicit ClipPlayer(std::shared_ptr<const AnimationClip> clip) : clip(std::move(clip)),
+                                                                     decoder(this->clip->pixel_count)
+    {
+    }
+
+    /**
+     * Draw the frame of the clip at the given time.
+     * @param time_ms time since the start of the animation in ms
+     * @param mm MatrixManager to draw on
+     * @return true if the animation is done, like Animation::run
+     */
+    bool play(double time_ms, MatrixManager* mm)
+    {
+        // the epsilon keeps frame times which are exact multiples from rounding down
+        const int frame = std::clamp(static_cast<int>(time_ms * clip->fps / 1000 + 0.001), 0,
+                                     clip->frame_count() - 1);
+        if (frame < decoded)
+        {
+            // the frames are deltas, start over with the key frame
+            decoded = -1;
+        }
+        while (decoded < frame)
+        {
+            decoded++;
+            const uint32_t end = decoded + 1 < clip->frame_count()
+                                     ? clip->offsets[decoded + 1]
+                                     : static_cast<uint32_t>(clip->data.size());
+            decoder.decode(clip->data.data() + clip->offsets[decoded],
+                           static_cast<int>(end - clip->offsets[decoded]));
+        }
+        mm->overlay(decoder.get_frame());
+        return clip->done[frame];
+    }
+
+private:
+    std::shared_ptr<const AnimationClip> clip;
+    FrameDecoder decoder;
+    int decoded = -1;
+};
+
+/**
+ * Keeps pre-rendered frames of deterministic animations, see Animation::cache_key.
+ * An animation is rendered once at a fixed frame rate and replayed from the cache
+ * whenever the same animation runs again. The cache stays below a memory limit by
+ * evicting the least recently used clips. Clips which are still playing stay valid
+ * until their player is gone.
+ */
+class AnimationCache
+{
+public:
+    /**
+     * @param max_bytes memory limit of all clips, 0 disables the cache
+     * @param fps frame rate the animations are rendered at
+     */
+    void configure(size_t max_bytes, int fps)
+    {
+        fps = std::clamp(fps, 1, 240);
+        this->max_bytes = max_bytes;
+        if (fps != this->fps)
+        {
+            clear();
+        }
+        this->fps = fps;
+        evict(nullptr);
+    }
+
+    bool is_enabled() const
+    {
+        return max_bytes > 0;
+    }
+
+    /**
+     * Get the memory used by all clips.
+     * @return size in bytes
+     */
+    size_t get_size() const
+    {
+        return bytes;
+    }
+
+    /**
+     * Get the clip of an animation, render it if it isn't cached yet. Rendering draws
+     * on the active layer, which has to be empty and is empty again afterwards.
+     * @param animation Animation to render, it is run with all frames
+     * @param duration_ms duration of the animation in ms
+     * @param keep_ms keep time of the animation in ms
+     * @param mm MatrixManager to render with
+     * @return clip or nullptr if the animation can't be cached
+     */
+    std::shared_ptr<const AnimationClip> get(Animation* animation, float duration_ms, float keep_ms, MatrixManager* mm)
+    {
+        const unsigned long long animation_key = animation->cache_key();
+        if (!is_enabled() || animation_key == 0)
+        {
+            return nullptr;
+        }
+        unsigned long long key = animation_key;
+        for (const unsigned long long value : {
+                 static_cast<unsigned long long>(duration_ms), static_cast<unsigned long long>(keep_ms),
+                 static_cast<unsigned long long>(fps), static_cast<unsigned long long>(mm->get_width()),
+                 static_cast<unsigned long long>(mm->get_height())
+             })
+        {
+            key = (key ^ value) * 0x100000001B3ULL;
+        }
+
+        const auto found = clips.find(key);
+        if (found != clips.end())
+        {
+            found->second->last_used = ++use_counter;
+            return found->second;
+        }
+
+        std::shared_ptr<AnimationClip> clip = render(animation, duration_ms, keep_ms, mm);
+        if (!clip)
+        {
+            return nullptr;
+        }
+        clip->last_used = ++use_counter;
+        if (clip->memory() <= max_bytes)
+        {
+            clips[key] = clip;
+            bytes += clip->memory();
+            evict(clip.get());
+        }
+        return clip;
+    }
+
+    /**
+     * Remove all clips.
+     */
+    void clear()
+    {
+        clips.clear();
+        bytes = 0;
+    }
+
+private:
+    // animations longer than this are not cached
+    static constexpr float MAX_CLIP_MS = 60000;
+
+    std::unordered_map<unsigned long long, std::shared_ptr<AnimationClip>> clips;
+    size_t max_bytes = 0;
+    size_t bytes = 0;
+    int fps = 30;
+    unsigned long long use_counter = 0;
+
+    std::shared_ptr<AnimationClip> render(Animation* animation, float duration_ms, float keep_ms, MatrixManager* mm)
+    {
+        const int layer = mm->get_layer();
+        if (!mm->get_layer_pixels(layer) || duration_ms + keep_ms > MAX_CLIP_MS)
+        {
+            return nullptr;
+        }
+        auto clip = std::make_shared<AnimationClip>();
+        clip->fps = fps;
+        clip->pixel_count = mm->get_width() * mm->get_height();
+        FrameEncoder encoder(clip->pixel_count);
+
+        // render until the first frame after the keep time, like the timeline would run it
+        const int frames = static_cast<int>((duration_ms + keep_ms) * fps / 1000) + 2;
+        for (int i = 0; i < frames; i++)
+        {
+            const float time_ms = static_cast<float>(i) * 1000 / static_cast<float>(fps);
+            mm->clear();
+            const bool done = animation->run(time_ms / duration_ms, mm);
+            const std::vector<uint8_t>& encoded = encoder.encode(mm->get_layer_pixels(layer));
+            clip->offsets.push_back(static_cast<uint32_t>(clip->data.size()));
+            clip->data.insert(clip->data.end(), encoded.begin(), encoded.end());
+            clip->done.push_back(done);
+        }
+        mm->clear();
+        if (!clip->done.back())
+        {
+            // the animation keeps running after the keep time, it can't be replayed
+            return nullptr;
+        }
+        clip->data.shrink_to_fit();
+        return clip;
+    }
+
+    /**
+     * Evict the least recently used clips until the cache fits its limit.
+     * @param keep clip which must not be evicted
+     */
+    void evict(const AnimationClip* keep)
+    {
+        while (bytes > max_bytes && !clips.empty())
+        {
+            auto oldest = clips.end();
+            for (auto it = clips.begin(); it != clips.end(); ++it)
+            {
+                if (it->second.get() != keep && (oldest == clips.end() ||
+                    it->second->last_used < oldest->second->last_used))
+                {
+                    oldest = it;
+                }
+            }
+            if (oldest == clips.end())
+            {
+                return;
+            }
+            bytes -= oldest->second->memory();
+            clips.erase(oldest);
+        }
+    }
+};
@@ -0,0 +1,232 @@
+#pragma once
+#include <chrono>
+
+/**
+ * Measures how often something happens, for example the achieved ticks or frames per second.
+ * The rate is calculated over the stamps of the last second, so a single slow frame doesn't
+ * make the value jump. The buffer holds a second at up to 255 stamps per second, which covers
+ * the tick cap of 200. Above that the window gets shorter.
+ */
+class RateMeter
+{
+public:
+    /**
+     * Record an occurrence.
+     * @param now current time in ms
+     */
+    void stamp(double now)
+    {
+        stamps[next] = now;
+        next = (next + 1) % WINDOW_STAMPS;
+        if (count < WINDOW_STAMPS)
+        {
+            count++;
+        }
+    }
+
+    /**
+     * Get the rate over the rolling window.
+     * @param now current time in ms
+     * @return occurrences per second, 0 if nothing happened within the window
+     */
+    float rate(double now) const
+    {
+        if (count < 2)
+        {
+            return 0;
+        }
+        const double newest = stamps[(next + WINDOW_STAMPS - 1) % WINDOW_STAMPS];
+        if (now - newest > WINDOW_MS)
+        {
+            return 0;
+        }
+        // skip the stamps which left the window
+        int first = (next + WINDOW_STAMPS - count) % WINDOW_STAMPS;
+        int used = count;
+        while (used > 2 && newest - stamps[first] > WINDOW_MS)
+        {
+            first = (first + 1) % WINDOW_STAMPS;
+            used--;
+        }
+        const double span = newest - stamps[first];
+        return span > 0 ? static_cast<float>((used - 1) * 1000.0 / span) : 0;
+    }
+
+    /**
+     * Forget all stamps.
+     */
+    void reset()
+    {
+        next = 0;
+        count = 0;
+    }
+
+private:
+    static constexpr int WINDOW_STAMPS = 256;
+    static constexpr double WINDOW_MS = 1000;
+
+    double stamps[WINDOW_STAMPS] = {};
+    int next = 0;
+    int count = 0;
+};
+
+/**
+ * Time source of the runtime. All animation timing reads the time from here.
+ * By default the clock follows a monotonic steady clock with sub-millisecond resolution,
+ * counted from the creation of the clock. A host can switch it to a virtual clock,
+ * which only moves when it is advanced. This way a program can be simulated faster
+ * (or slower) than real time.
+ * The runtime stamps every draw and game_loop call, animations of a frame all see the
+ * time of its stamp and the achieved rates are measured from the stamps.
+ */
+class Clock
+{
+public:
+    Clock() : origin(std::chrono::steady_clock::now())
+    {
+    }
+
+    /**
+     * Get the current time.
+     * @return time in ms
+     */
+    double now_ms() const
+    {
+        if (virtual_time)
+        {
+            return virtual_ms;
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    /**
+     * Switch between the steady clock and the virtual clock.
+     * The virtual clock continues at the current time, so running animations won't jump.
+     * Switching back to the steady clock is only meant for a fresh program.
+     * @param enabled true to use the virtual clock
+     */
+    void set_virtual(bool enabled)
+    {
+        if (enabled && !virtual_time)
+        {
+            virtual_ms = now_ms();
+        }
+        virtual_time = enabled;
+    }
+
+    bool is_virtual() const
+    {
+        return virtual_time;
+    }
+
+    /**
+     * Move the virtual clock forward. Has no effect while the steady clock is used.
+     * @param ms time in ms
+     */
+    void advance(double ms)
+    {
+        if (ms > 0)
+        {
+            virtual_ms += ms;
+        }
+    }
+
+    /**
+     * Stamp the start of a frame.
+     */
+    void begin_frame()
+    {
+        const double now = now_ms();
+        frame_delta = first_frame ? 0 : now - frame_ms;
+        first_frame = false;
+        frame_ms = now;
+        frames.stamp(now);
+        in_frame = true;
+    }
+
+    /**
+     * Mark the end of the current frame.
+     */
+    void end_frame()
+    {
+        in_frame = false;
+    }
+
+    /**
+     * Get the time an animation started now begins at. Within a frame this is the
+     * frame stamp, so the animation is stepped from progress 0 in the same frame.
+     * Between frames, for example in on_event, it is the current time.
+     * @return time in ms
+     */
+    double start_time() const
+    {
+        return in_frame ? frame_ms : now_ms();
+    }
+
+    /**
+     * Stamp the start of a tick.
+     */
+    void begin_tick()
+    {
+        ticks.stamp(now_ms());
+    }
+
+    /**
+     * Get the time of the current frame.
+     * @return time in ms, stamped by begin_frame
+     */
+    double frame_time() const
+    {
+        return frame_ms;
+    }
+
+    /**
+     * Get the time between the current and the previous frame.
+     * @return time in ms, 0 for the first frame
+     */
+    double frame_delta_ms() const
+    {
+        return frame_delta;
+    }
+
+    /**
+     * Get the measured frames per second.
+     * @return frames per second within the last second
+     */
+    float get_fps() const
+    {
+        return frames.rate(now_ms());
+    }
+
+    /**
+     * Get the measured ticks per second.
+     * @return ticks per second within the last second
+     */
+    float get_tps() const
+    {
+        return ticks.rate(now_ms());
+    }
+
+    /**
+     * Forget the stamps of the previous program.
+     */
+    void reset_rates()
+    {
+        frames.reset();
+        ticks.reset();
+        frame_delta = 0;
+        first_frame = true;
+        in_frame = false;
+    }
+
+private:
+    std::chrono::steady_clock::time_point origin;
+    bool virtual_time = false;
+    double virtual_ms = 0;
+    double frame_ms = 0;
+    double frame_delta = 0;
+    bool first_frame = true;
+    bool in_frame = false;
+    RateMeter frames;
+    RateMeter ticks;
+};
@@ -1,7 +1,8 @@
 #pragma once
 #include "Animation.h"
+#include "Clock.h"
+#include "Timeline.h"
 #include <functional>
-#include <chrono>
 
 /**
  * Used to set the current status and controls of your application.
@@ -10,9 +11,10 @@
 class ControlManager
 {
 public:
-    ControlManager(std::function<void()> change)
+    ControlManager(std::function<void()> change, Clock* clock)
     {
         this->change = change;
+        this->clock = clock;
     }
 
     /**
@@ -79,7 +81,17 @@ public:
 
       bool is_animation_running()
     {
-        return current_animation!=nullptr;
+        return !timeline.empty();
+    }
+
+    /**
+     * Check if a specific animation is running or waiting to start.
+     * @param id id returned by run_animation
+     * @return bool
+     */
+    bool is_animation_running(int id)
+    {
+        return timeline.is_running(id);
     }
 
 
@@ -88,56 +100,61 @@ public:
      * will be stopped after the given keep_time. If the keep_time is 0, the animation
      * will be played until it is done. You need to call this function once to run an animation.
      * Each frame will than be handled internally.
-     * @param newAnimation Animation
+     * Any number of animations can run at the same time, they are drawn in the order they were started.
+     * @param newAnimation Animation, deleted once it is finished
      * @param duration_ms duration in ms
      * @param keep_time duration in ms
+     * @param delay_ms (optional) time in ms until the animation starts
+     * @param after (optional) id of an animation which has to finish before the delay starts
+     * @return id of the animation
      */
-    void run_animation(Animation* newAnimation, int duration_ms, int keep_time = 0) {
-        this->current_animation = newAnimation;
-        this->duration_ms = duration_ms;
-        const auto p1 = std::chrono::system_clock::now();
-
-        this->animation_start_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-                   p1.time_since_epoch()).count();
-        this->keep_time = keep_time;
+    int run_animation(Animation* newAnimation, int duration_ms, int keep_time = 0, int delay_ms = 0,
+                      int after = -1) {
+        return timeline.add(newAnimation, clock->start_time(), duration_ms, keep_time, delay_ms, after);
     }
 
     /**
-     * Stop an animation before it is finished. 
+     * Stop all animations before they are finished.
      */
     void stop_animation() {
-        this->current_animation = nullptr;
-    }
-
-    Animation* __internal_get_animation() {
-        return this->current_animation;
+        timeline.stop_all();
     }
 
-    void __internal_set_animation(Animation* animation) {
-        this->current_animation = animation;
+    /**
+     * Stop a specific animation before it is finished.
+     * @param id id returned by run_animation
+     */
+    void stop_animation(int id) {
+        timeline.stop(id);
     }
 
-    float __internal_get_animation_duration() {
-        return this->duration_ms;
+    /**
+     * Draw the current frame of all running animations.
+     * @param mm MatrixManager
+     * @param finished receives the ids of the animations which finished
+     */
+    void __internal_step_animations(MatrixManager* mm, std::vector<int>& finished) {
+        timeline.step(mm, clock->frame_time(), finished);
     }
 
-
-    float __interal_get_animation_keep_time() {
-        return this->keep_time;
+    /**
+     * Replay cacheable animations from pre-rendered frames.
+     * @param cache AnimationCache, nullptr to always run the animations
+     */
+    void set_animation_cache(AnimationCache* cache) {
+        timeline.set_cache(cache);
     }
 
-    long long __internal_get_animation_start() {
-        return this->animation_start_time;
+    Clock* __internal_get_clock() {
+        return this->clock;
     }
 
 private:
     uint8_t controls = 0x00;
     std::string status = "";
     std::function<void()> change;
-       Animation* current_animation = nullptr;
-    float duration_ms = 0;
-    long long animation_start_time = 0;
-    float keep_time = 0;
+    Clock* clock;
+    Timeline timeline;
 };
 
 uint8_t button_up = 0b00000001;
@@ -0,0 +1,101 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Easing functions for animations. Every function maps the linear progress of an
+ * animation from 0 to 1 onto an eased progress, which starts at 0 and ends at 1.
+ * Elastic easing overshoots in between, so the result can leave the range 0 to 1.
+ */
+namespace easing
+{
+    enum Ease
+    {
+        EASE_LINEAR = 0,
+        EASE_QUAD_IN,
+        EASE_QUAD_OUT,
+        EASE_QUAD_IN_OUT,
+        EASE_CUBIC_IN,
+        EASE_CUBIC_OUT,
+        EASE_CUBIC_IN_OUT,
+        EASE_ELASTIC_IN,
+        EASE_ELASTIC_OUT,
+        EASE_BOUNCE_IN,
+        EASE_BOUNCE_OUT,
+        EASE_STEPS,
+        EASE_COUNT
+    };
+
+    inline float elastic_out(float t)
+    {
+        if (t <= 0 || t >= 1)
+        {
+            return t <= 0 ? 0.0f : 1.0f;
+        }
+        constexpr float period = 2 * 3.14159265f / 3;
+        return std::pow(2.0f, -10 * t) * std::sin((t * 10 - 0.75f) * period) + 1;
+    }
+
+    inline float bounce_out(float t)
+    {
+        constexpr float n = 7.5625f;
+        constexpr float d = 2.75f;
+        if (t < 1 / d)
+        {
+            return n * t * t;
+        }
+        if (t < 2 / d)
+        {
+            t -= 1.5f / d;
+            return n * t * t + 0.75f;
+        }
+        if (t < 2.5f / d)
+        {
+            t -= 2.25f / d;
+            return n * t * t + 0.9375f;
+        }
+        t -= 2.625f / d;
+        return n * t * t + 0.984375f;
+    }
+
+    /**
+     * Ease a progress value.
+     * @param ease easing function, see Ease, unknown values are linear
+     * @param t progress from 0 to 1, clamped
+     * @param steps (optional) amount of steps for EASE_STEPS
+     * @return eased progress
+     */
+    inline float apply(int ease, float t, int steps = 4)
+    {
+        t = std::clamp(t, 0.0f, 1.0f);
+        const float u = 1 - t;
+        switch (ease)
+        {
+        case EASE_QUAD_IN:
+            return t * t;
+        case EASE_QUAD_OUT:
+            return 1 - u * u;
+        case EASE_QUAD_IN_OUT:
+            return t < 0.5f ? 2 * t * t : 1 - 2 * u * u;
+        case EASE_CUBIC_IN:
+            return t * t * t;
+        case EASE_CUBIC_OUT:
+            return 1 - u * u * u;
+        case EASE_CUBIC_IN_OUT:
+            return t < 0.5f ? 4 * t * t * t : 1 - 4 * u * u * u;
+        case EASE_ELASTIC_IN:
+            return 1 - elastic_out(u);
+        case EASE_ELASTIC_OUT:
+            return elastic_out(t);
+        case EASE_BOUNCE_IN:
+            return 1 - bounce_out(u);
+        case EASE_BOUNCE_OUT:
+            return bounce_out(t);
+        case EASE_STEPS:
+            steps = std::max(steps, 1);
+            return std::min(std::floor(t * static_cast<float>(steps)) / static_cast<float>(steps), 1.0f);
+        default:
+            return t;
+        }
+    }
+}
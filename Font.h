@@ -0,0 +1,138 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Bitmap font with 3x5 glyphs for the printable ASCII characters (32 - 126).
+ * Every glyph is stored as five rows of three bits, top row first. Written in octal,
+ * each digit is one row and the highest bit of a digit is the left column.
+ * Lowercase letters use the uppercase glyphs.
+ */
+namespace font
+{
+    constexpr int GLYPH_WIDTH = 3;
+    constexpr int GLYPH_HEIGHT = 5;
+
+    constexpr uint16_t glyphs[95] = {
+        000000, // space
+        022202, // !
+        055000, // "
+        057575, // #
+        036236, // $
+        051245, // %
+        025356, // &
+        022000, // '
+        012221, // (
+        042224, // )
+        005250, // *
+        002720, // +
+        000024, // ,
+        000700, // -
+        000002, // .
+        011244, // /
+        075557, // 0
+        026227, // 1
+        071747, // 2
+        071717, // 3
+        055711, // 4
+        074717, // 5
+        074757, // 6
+        071111, // 7
+        075757, // 8
+        075717, // 9
+        002020, // :
+        002024, // ;
+        012421, // <
+        007070, // =
+        042124, // >
+        071202, // ?
+        025743, // @
+        025755, // A
+        065656, // B
+        034443, // C
+        065556, // D
+        074647, // E
+        074644, // F
+        034553, // G
+        055755, // H
+        072227, // I
+        011152, // J
+        055655, // K
+        044447, // L
+        057755, // M
+        065555, // N
+        025552, // O
+        065644, // P
+        025563, // Q
+        065655, // R
+        034716, // S
+        072222, // T
+        055557, // U
+        055552, // V
+        055775, // W
+        055255, // X
+        055222, // Y
+        071247, // Z
+        064446, // [
+        044211, // backslash
+        031113, // ]
+        025000, // ^
+        000007, // _
+        042000, // `
+        025755, // a
+        065656, // b
+        034443, // c
+        065556, // d
+        074647, // e
+        074644, // f
+        034553, // g
+        055755, // h
+        072227, // i
+        011152, // j
+        055655, // k
+        044447, // l
+        057755, // m
+        065555, // n
+        025552, // o
+        065644, // p
+        025563, // q
+        065655, // r
+        034716, // s
+        072222, // t
+        055557, // u
+        055552, // v
+        055775, // w
+        055255, // x
+        055222, // y
+        071247, // z
+        032623, // {
+        022222, // |
+        062326, // }
+        003600, // ~
+    };
+
+    /**
+     * Get the glyph of a character. Characters without a glyph are drawn as '?'.
+     * @param c character
+     * @return glyph rows, see glyphs
+     */
+    constexpr uint16_t glyph(char c)
+    {
+        if (c < 32 || c > 126)
+        {
+            c = '?';
+        }
+        return glyphs[c - 32];
+    }
+
+    /**
+     * Check if a pixel of a glyph is set.
+     * @param glyph glyph rows
+     * @param col column, 0 is left
+     * @param row row, 0 is the bottom
+     * @return bool
+     */
+    constexpr bool glyph_pixel(uint16_t glyph, int col, int row)
+    {
+        return glyph >> (row * GLYPH_WIDTH + GLYPH_WIDTH - 1 - col) & 1;
+    }
+}
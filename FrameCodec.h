@@ -0,0 +1,262 @@
+#pragma once
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+/**
+ * Compact encoding of led frames for the transport to remote panels.
+ * A frame is encoded against the previous frame, so pixels which didn't change cost
+ * close to nothing. Every encoded frame starts with a flag byte (FRAME_KEY if the frame
+ * doesn't depend on the previous one), followed by operations. The upper two bits of an
+ * operation select it, the lower six bits hold a count or an index:
+ *
+ *  CODEC_SKIP    count-1: the next count pixels didn't change
+ *  CODEC_INDEX   index:   the next pixel has the color at index of the color cache
+ *  CODEC_RUN     count-1: the next count pixels have the color of the last pixel
+ *  CODEC_LITERAL count-1: the next count pixels follow as red, green, blue bytes
+ *
+ * The color cache has 64 entries and holds the last literal color for each hash,
+ * encoder and decoder update it the same way. Pixels after the last operation didn't change.
+ */
+namespace frame_codec
+{
+    constexpr uint8_t FRAME_KEY = 1;
+
+    constexpr uint8_t CODEC_SKIP = 0x00;
+    constexpr uint8_t CODEC_INDEX = 0x40;
+    constexpr uint8_t CODEC_RUN = 0x80;
+    constexpr uint8_t CODEC_LITERAL = 0xC0;
+    constexpr int CODEC_MAX_COUNT = 64;
+    constexpr int CACHE_SIZE = 64;
+
+    inline int color_hash(uint32_t color)
+    {
+        return ((color >> 16 & 0xFF) * 3 + (color >> 8 & 0xFF) * 5 + (color & 0xFF) * 7) % CACHE_SIZE;
+    }
+}
+
+/**
+ * Encodes consecutive frames, see frame_codec.
+ */
+class FrameEncoder
+{
+public:
+    /**
+     * @param pixel_count amount of pixels of every frame
+     */
+    explicit FrameEncoder(int pixel_count) : previous(pixel_count, 0)
+    {
+        out.reserve(pixel_count * 3 + pixel_count / frame_codec::CODEC_MAX_COUNT + 2);
+    }
+
+    /**
+     * Encode the next frame as a key frame, for example if a receiver lost track.
+     */
+    void reset()
+    {
+        key = true;
+    }
+
+    /**
+     * Encode a frame against the previously encoded frame.
+     * @param frame the colors of all pixels
+     * @return the encoded frame, valid until the next call
+     */
+    const std::vector<uint8_t>& encode(const uint32_t* frame)
+    {
+        using namespace frame_codec;
+        out.clear();
+        out.push_back(key ? FRAME_KEY : 0);
+        if (key)
+        {
+            std::fill(std::begin(cache), std::end(cache), 0);
+        }
+
+        uint32_t last = 0;
+        int skip = 0;
+        int run = 0;
+        literal_start = 0;
+        literal_count = 0;
+        const int pixel_count = static_cast<int>(previous.size());
+        for (int i = 0; i < pixel_count; i++)
+        {
+            const uint32_t color = frame[i] & 0xFFFFFF;
+            if (!key && color == previous[i])
+            {
+                flush_run(run);
+                flush_literal(frame);
+                if (++skip == CODEC_MAX_COUNT)
+                {
+                    flush_skip(skip);
+                }
+                continue;
+            }
+            flush_skip(skip);
+            previous[i] = color;
+
+            if (color == last)
+            {
+                flush_literal(frame);
+                if (++run == CODEC_MAX_COUNT)
+                {
+                    flush_run(run);
+                }
+                continue;
+            }
+            flush_run(run);
+            last = color;
+
+            const int hash = color_hash(color);
+            if (cache[hash] == color)
+            {
+                flush_literal(frame);
+                out.push_back(CODEC_INDEX | hash);
+                continue;
+            }
+            cache[hash] = color;
+            if (literal_count == 0)
+            {
+                literal_start = i;
+            }
+            if (++literal_count == CODEC_MAX_COUNT)
+            {
+                flush_literal(frame);
+            }
+        }
+        flush_run(run);
+        flush_literal(frame);
+        key = false;
+        return out;
+    }
+
+private:
+    std::vector<uint32_t> previous;
+    std::vector<uint8_t> out;
+    uint32_t cache[frame_codec::CACHE_SIZE] = {};
+    bool key = true;
+    int literal_start = 0;
+    int literal_count = 0;
+
+    void flush_skip(int& skip)
+    {
+        if (skip > 0)
+        {
+            out.push_back(frame_codec::CODEC_SKIP | (skip - 1));
+            skip = 0;
+        }
+    }
+
+    void flush_run(int& run)
+    {
+        if (run > 0)
+        {
+            out.push_back(frame_codec::CODEC_RUN | (run - 1));
+            run = 0;
+        }
+    }
+
+    void flush_literal(const uint32_t* frame)
+    {
+        if (literal_count == 0)
+        {
+            return;
+        }
+        out.push_back(frame_codec::CODEC_LITERAL | (literal_count - 1));
+        // runs and cached colors can't be part of a literal, so the pixels are consecutive
+        for (int i = literal_start; i < literal_start + literal_count; i++)
+        {
+            out.push_back(frame[i] >> 16 & 0xFF);
+            out.push_back(frame[i] >> 8 & 0xFF);
+            out.push_back(frame[i] & 0xFF);
+        }
+        literal_count = 0;
+    }
+};
+
+/**
+ * Decodes frames produced by FrameEncoder, see frame_codec.
+ */
+class FrameDecoder
+{
+public:
+    /**
+     * @param pixel_count amount of pixels of every frame
+     */
+    explicit FrameDecoder(int pixel_count) : frame(pixel_count, 0)
+    {
+    }
+
+    /**
+     * Apply an encoded frame. Delta frames are only meaningful after the frame they were
+     * encoded against, a receiver which joins late has to wait for a key frame.
+     * @param data the encoded frame
+     * @param length size of the encoded frame in bytes
+     * @return false if the data is malformed, the frame is undefined until the next key frame
+     */
+    bool decode(const uint8_t* data, int length)
+    {
+        using namespace frame_codec;
+        if (length < 1)
+        {
+            return false;
+        }
+        if (data[0] & FRAME_KEY)
+        {
+            std::fill(std::begin(cache), std::end(cache), 0);
+        }
+
+        const int pixel_count = static_cast<int>(frame.size());
+        uint32_t last = 0;
+        int i = 0;
+        int p = 1;
+        while (p < length)
+        {
+            const uint8_t op = data[p] & 0xC0;
+            const int arg = data[p++] & 0x3F;
+            const int count = op == CODEC_INDEX ? 1 : arg + 1;
+            if (i + count > pixel_count)
+            {
+                return false;
+            }
+            switch (op)
+            {
+            case CODEC_SKIP:
+                break;
+            case CODEC_INDEX:
+                last = cache[arg];
+                frame[i] = last;
+                break;
+            case CODEC_RUN:
+                std::fill_n(frame.begin() + i, count, last);
+                break;
+            default:
+                if (p + count * 3 > length)
+                {
+                    return false;
+                }
+                for (int k = 0; k < count; k++, p += 3)
+                {
+                    last = data[p] << 16 | data[p + 1] << 8 | data[p + 2];
+                    cache[color_hash(last)] = last;
+                    frame[i + k] = last;
+                }
+                break;
+            }
+            i += count;
+        }
+        return true;
+    }
+
+    /**
+     * Get the decoded frame.
+     * @return pointer to the colors of all pixels
+     */
+    const uint32_t* get_frame() const
+    {
+        return frame.data();
+    }
+
+private:
+    std::vector<uint32_t> frame;
+    uint32_t cache[frame_codec::CACHE_SIZE] = {};
+};
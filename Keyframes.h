@@ -0,0 +1,112 @@
+#pragma once
+#include "Easing.h"
+#include "MatrixManager.h"
+#include <vector>
+
+/**
+ * Interpolates a value between keyframes, for example a position, a radius or a color.
+ * A keyframe holds the value at a point in time of the animation, from 0 to 1. The ease
+ * of a keyframe shapes the way to the next keyframe. Before the first and after the last
+ * keyframe the value stays at the value of that keyframe.
+ */
+class Keyframes
+{
+public:
+    /**
+     * Add a keyframe. Keyframes can be added in any order.
+     * @param time point in time from 0 to 1
+     * @param value value at that point
+     * @param ease (optional) easing towards the next keyframe, see easing::Ease
+     * @param steps (optional) amount of steps for easing::EASE_STEPS
+     */
+    void add(float time, int32_t value, int ease = easing::EASE_LINEAR, int steps = 4)
+    {
+        const Keyframe key{time, value, ease, steps};
+        keys.insert(std::upper_bound(keys.begin(), keys.end(), key, [](const Keyframe& a, const Keyframe& b)
+        {
+            return a.time < b.time;
+        }), key);
+    }
+
+    bool empty() const
+    {
+        return keys.empty();
+    }
+
+    /**
+     * Get the interpolated value.
+     * @param progress progress of the animation from 0 to 1
+     * @return value, rounded to the nearest integer
+     */
+    int32_t value(float progress) const
+    {
+        if (keys.empty())
+        {
+            return 0;
+        }
+        int first = 0;
+        const float amount = segment(progress, first);
+        if (first + 1 >= static_cast<int>(keys.size()))
+        {
+            return keys[first].value;
+        }
+        const float from = static_cast<float>(keys[first].value);
+        const float to = static_cast<float>(keys[first + 1].value);
+        return static_cast<int32_t>(std::lround(from + (to - from) * amount));
+    }
+
+    /**
+     * Get the interpolated color. All channels are interpolated separately.
+     * @param progress progress of the animation from 0 to 1
+     * @return color
+     */
+    uint32_t color(float progress) const
+    {
+        if (keys.empty())
+        {
+            return 0;
+        }
+        int first = 0;
+        const float amount = segment(progress, first);
+        if (first + 1 >= static_cast<int>(keys.size()))
+        {
+            return keys[first].value;
+        }
+        return MatrixManager::lerp_color(keys[first].value, keys[first + 1].value,
+                                         static_cast<int>(amount * 256));
+    }
+
+private:
+    struct Keyframe
+    {
+        float time;
+        int32_t value;
+        int ease;
+        int steps;
+    };
+
+    std::vector<Keyframe> keys;
+
+    /**
+     * Find the keyframes around the progress.
+     * @param progress progress of the animation
+     * @param first receives the index of the keyframe before the progress
+     * @return eased amount towards the next keyframe
+     */
+    float segment(float progress, int& first) const
+    {
+        const int count = static_cast<int>(keys.size());
+        first = 0;
+        while (first + 1 < count && keys[first + 1].time <= progress)
+        {
+            first++;
+        }
+        if (first + 1 >= count || progress <= keys[first].time)
+        {
+            return 0;
+        }
+        const Keyframe& key = keys[first];
+        const float span = keys[first + 1].time - key.time;
+        return easing::apply(key.ease, (progress - key.time) / span, key.steps);
+    }
+};
@@ -2,17 +2,274 @@
 #include <stdint.h>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <string>
+#include <vector>
+#include "Font.h"
+
+/**
+ * How the leds of a single panel are chained.
+ */
+enum MatrixWiring
+{
+    // rows from top to bottom, each row from left to right
+    WIRING_ROW_MAJOR = 0,
+    // rows from top to bottom, alternating the direction of every row
+    WIRING_SERPENTINE = 1,
+    // columns from left to right, starting bottom left and alternating the direction of every column
+    WIRING_COLUMN_SERPENTINE = 2,
+    // rows from top to bottom, each row from right to left
+    WIRING_MIRRORED = 3,
+    // row major, but the panel is mounted upside down
+    WIRING_ROTATED = 4,
+};
+
+/**
+ * Describes the size of the matrix. A matrix consists of one or more panels of the
+ * same size. The panels are chained row by row, starting with the top left panel.
+ */
+struct MatrixGeometry
+{
+    int panel_width = 12;
+    int panel_height = 12;
+    int tiles_x = 1;
+    int tiles_y = 1;
+    MatrixWiring wiring = WIRING_ROW_MAJOR;
+
+    int width() const
+    {
+        return panel_width * tiles_x;
+    }
+
+    int height() const
+    {
+        return panel_height * tiles_y;
+    }
+
+    int pixel_count() const
+    {
+        return width() * height();
+    }
+};
+
+/**
+ * The layers of the matrix, from bottom to top. While animations run, the runtime
+ * redraws the animation layer every frame, otherwise programs can draw on it.
+ */
+enum MatrixLayer
+{
+    LAYER_BACKGROUND = 0,
+    LAYER_GAME = 1,
+    LAYER_UI = 2,
+    LAYER_ANIMATION = 3,
+    LAYER_COUNT = 4,
+};
+
+/**
+ * How a layer is combined with the layers below it.
+ */
+enum BlendMode
+{
+    // the layer covers the layers below
+    BLEND_NORMAL = 0,
+    // the colors are added
+    BLEND_ADD = 1,
+    // the colors are multiplied, useful to darken parts of the frame
+    BLEND_MULTIPLY = 2,
+};
+
+/**
+ * A layer of the matrix in matrix order. Pixels which are off (0) are transparent,
+ * except on the background layer.
+ * In indexed mode a layer stores one palette index per pixel instead of a color and
+ * index 0 is transparent. The palette is only resolved when the layers are composed,
+ * so changing the palette recolors the layer without drawing it again.
+ */
+struct Layer
+{
+    std::vector<uint32_t> pixels;
+    // palette indices, replace pixels in indexed mode
+    std::vector<uint8_t> indices;
+    std::vector<uint32_t> palette;
+    // 0 for colors, otherwise 4 or 8 bits per index
+    int index_bits = 0;
+    uint8_t opacity = 255;
+    BlendMode blend = BLEND_NORMAL;
+    bool visible = true;
+    // something changed since the last composition
+    bool dirty = false;
+    // all pixels are off, the layer can be skipped
+    bool empty = true;
+    // the pixels were handed out for direct access, changes can't be tracked
+    bool exposed = false;
+
+    /**
+     * Set a pixel. In indexed mode the color is the palette index.
+     */
+    void put(int pixel, uint32_t color)
+    {
+        if (index_bits)
+        {
+            indices[pixel] = static_cast<uint8_t>(color & (palette.size() - 1));
+        }
+        else
+        {
+            pixels[pixel] = color;
+        }
+    }
+
+    /**
+     * Set count pixels starting at pixel to the same color.
+     */
+    void fill(int pixel, int count, uint32_t color)
+    {
+        if (index_bits)
+        {
+            std::fill_n(indices.data() + pixel, count, static_cast<uint8_t>(color & (palette.size() - 1)));
+        }
+        else
+        {
+            std::fill_n(pixels.data() + pixel, count, color);
+        }
+    }
+
+    /**
+     * Copy count colors to the pixels starting at pixel.
+     */
+    void copy(int pixel, const uint32_t* colors, int count)
+    {
+        if (index_bits)
+        {
+            const uint8_t mask = static_cast<uint8_t>(palette.size() - 1);
+            for (int i = 0; i < count; i++)
+            {
+                indices[pixel + i] = static_cast<uint8_t>(colors[i] & mask);
+            }
+        }
+        else
+        {
+            std::copy(colors, colors + count, pixels.data() + pixel);
+        }
+    }
+};
+
+/**
+ * Flags to mirror a sprite while drawing it.
+ */
+enum SpriteFlip
+{
+    FLIP_NONE = 0,
+    FLIP_X = 1,
+    FLIP_Y = 2,
+};
+
+/**
+ * Operations of a draw command buffer, see MatrixManager::execute.
+ * Each operation is followed by a fixed amount of arguments.
+ */
+enum DrawOp
+{
+    // x, y, color
+    OP_SET = 1,
+    // x1, y1, x2, y2, color
+    OP_LINE = 2,
+    // x1, x2, y, color
+    OP_HLINE = 3,
+    // x, y1, y2, color
+    OP_VLINE = 4,
+    // x, y, width, height, color
+    OP_RECT = 5,
+    // x, y, width, height, color
+    OP_RECT_FILLED = 6,
+    // x, y, radius, color
+    OP_CIRCLE = 7,
+    // x, y, radius, color
+    OP_CIRCLE_FILLED = 8,
+    // x, y, n, color
+    OP_NUMBER = 9,
+    // color
+    OP_FILL = 10,
+    // no arguments
+    OP_CLEAR = 11,
+    // id, x, y, flip
+    OP_BLIT = 12,
+    // layer
+    OP_LAYER = 13,
+};
+
+/**
+ * Amount of arguments of each DrawOp.
+ */
+constexpr int DRAW_OP_ARGUMENTS[] = {0, 3, 5, 4, 4, 5, 5, 4, 4, 4, 1, 0, 4, 1};
+
+/**
+ * Largest sprite in pixels, 4 MB of colors. Sprites come from programs, so their size is capped.
+ */
+constexpr long long MAX_SPRITE_PIXELS = 1 << 20;
+
+/**
+ * A bitmap registered once and drawn many times. The pixels are stored in matrix order
+ * (row by row, starting bottom left). The opaque pixels of every row are kept as spans,
+ * so transparent pixels cost nothing while drawing.
+ */
+struct Sprite
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;
+    // pairs of (start, length) of the opaque pixels, row by row
+    std::vector<uint16_t> spans;
+    // index of the first span of each row, plus the end of the last row
+    std::vector<uint32_t> row_spans;
+};
+
 /**
  * Controls the matrix and provides methods to set pixels.
+ * All drawing goes into the active layer in matrix order (row by row, starting bottom left).
+ * present() composes the layers, maps the result to strip order and publishes it as the
+ * next front buffer, so the led buffer handed out by get_leds always contains a complete frame.
+ * Programs draw into the game layer by default, animations into the animation layer.
  */
 class MatrixManager
 {
 public:
-    MatrixManager(uint32_t* pixels, bool inverse = false)
+    /**
+     * @param inverse (optional) mirror the wiring of each panel
+     * @param geometry (optional) size of the matrix, a single 12x12 panel by default
+     */
+    MatrixManager(bool inverse = false, MatrixGeometry geometry = MatrixGeometry())
     {
-        this->pixels = pixels;
         this->inverse = inverse;
+        this->geometry = geometry;
+        this->width = geometry.width();
+        this->height = geometry.height();
+        this->pixel_count = geometry.pixel_count();
+        this->back.assign(pixel_count, 0);
+        this->expanded.assign(pixel_count, 0);
+        for (Layer& layer : layers)
+        {
+            layer.pixels.assign(pixel_count, 0);
+        }
+        this->front[0].assign(pixel_count, 0);
+        this->front[1].assign(pixel_count, 0);
+        this->front_buffer.store(front[0].data());
+        this->dirty.assign(pixel_count, 0);
+        this->dirty_rows.assign(height, 0);
+        this->exported.assign(pixel_count, 0);
+
+        // the mapping is fixed for the lifetime of the manager, so mapping a pixel is a single lookup
+        this->strip_map.resize(pixel_count);
+        this->matrix_map.resize(pixel_count);
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                const int strip_pixel = this->map_strip_pixel(x, y);
+                strip_map[y * width + x] = strip_pixel;
+                matrix_map[strip_pixel] = y * width + x;
+            }
+        }
     }
 
     /**
@@ -24,7 +281,16 @@ public:
      */
     void set(int x, int y, uint32_t color, bool ignoreOutOfRange = false)
     {
-        this->set(x, y, color >> 16, color >> 8 & 0xFF, color & 0xFF, ignoreOutOfRange);
+        if (x < 0 || x >= width || y < 0 || y >= height)
+        {
+            if (!ignoreOutOfRange)
+            {
+                std::cout << "Out of range" << std::endl;
+
+            }
+            return;
+        }
+        canvas().put(y * width + x, color);
     }
 
     /**
@@ -34,7 +300,7 @@ public:
      */
     void off(int x, int y)
     {
-        this->set(x, y, 0, 0, 0);
+        this->set(x, y, 0u);
     }
 
     /**
@@ -48,18 +314,7 @@ public:
      */
     void set(const int x, const int y, const int r, const int g, const int b, const bool ignoreOutOfRange = false)
     {
-        if (x < 0 || x > 11 || y < 0 || y > 11)
-        {
-            if (!ignoreOutOfRange)
-            {
-                std::cout << "Out of range" << std::endl;
-
-            }
-            return;
-        }
-        int pixel = this->calculate_strip_pixel(x, y);
-        pixels[pixel] = (r << 16) | (g << 8) | b;
-
+        this->set(x, y, clamped_color(r, g, b), ignoreOutOfRange);
     }
 
     /**
@@ -70,7 +325,13 @@ public:
      */
     void set_string(int n, uint32_t color)
     {
-        this->set_string(n, color >> 16, color >> 8 & 0xFF, color & 0xFF);
+        if (n < 0 || n >= pixel_count)
+        {
+            std::cout << "Out of range" << std::endl;
+
+            return;
+        }
+        canvas().put(matrix_map[n], color);
     }
 
     /**
@@ -83,15 +344,7 @@ public:
      */
     void set_string(int n, int r, int g, int b)
     {
-        if (n > 143)
-        {
-            std::cout << "Out of range" << std::endl;
-
-            return;
-        }
-        int pixel = n;
-        pixels[pixel] = (r << 16) | (g << 8) | b;
-
+        this->set_string(n, clamped_color(r, g, b));
     }
 
     /**
@@ -101,7 +354,7 @@ public:
 
     void fill(uint32_t color)
     {
-        this->fill(color >> 16, color >> 8 & 0xFF, color & 0xFF);
+        canvas().fill(0, pixel_count, color);
     }
 
     /**
@@ -112,440 +365,1848 @@ public:
      */
     void fill(int r, int g, int b)
     {
-        for (int i = 0; i < 144; i++)
-        {
-            pixels[i] = (r << 16) | (g << 8) | b;
-
-        }
+        this->fill(clamped_color(r, g, b));
     }
 
     /**
      * Clear the complete matrix. By turning all the pixels off.
+     * Only the active layer is cleared.
      */
 
     void clear()
     {
-        for (int i = 0; i < 144; i++)
-        {
-            pixels[i] = 0;
+        this->clear_layer(active_layer);
+    }
 
+    /**
+     * Select the layer all drawing functions paint into.
+     * @param layer layer id, see MatrixLayer
+     */
+    void set_layer(int layer)
+    {
+        if (layer < 0 || layer >= LAYER_COUNT)
+        {
+            std::cout << "Out of range" << std::endl;
+            return;
         }
+        active_layer = layer;
     }
 
     /**
-     * Draw a line from (x1,y1) to (x2,y2) with a specific color.
-     * @param x1 x-coordinate of the start point
-     * @param y1 y-coordinate of the start point
-     * @param x2 x-coordinate of the end point
-     * @param y2 y-coordinate of the end point
-     * @param color color of the line
+     * Get the layer all drawing functions paint into.
+     * @return layer id
      */
-
-    void line(int x1, int y1, int x2, int y2, uint32_t color)
+    int get_layer()
     {
-        int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
-        int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
-        int err = dx + dy, e2; /* error value e_xy */
+        return active_layer;
+    }
 
-        for (;;)
+    /**
+     * Turn off all pixels of a layer.
+     * @param layer layer id, see MatrixLayer
+     */
+    void clear_layer(int layer)
+    {
+        if (layer < 0 || layer >= LAYER_COUNT)
         {
-            this->set(x1, y1, color);
-            if (x1 == x2 && y1 == y2)
-                break;
-            e2 = 2 * err;
-            if (e2 >= dy)
-            {
-                err += dy;
-                x1 += sx;
-            } /* e_xy+e_x > 0 */
-            if (e2 <= dx)
-            {
-                err += dx;
-                y1 += sy;
-            } /* e_xy+e_y < 0 */
+            std::cout << "Out of range" << std::endl;
+            return;
+        }
+        Layer& l = layers[layer];
+        if (l.empty)
+        {
+            return;
         }
+        std::fill(l.pixels.begin(), l.pixels.end(), 0);
+        std::fill(l.indices.begin(), l.indices.end(), 0);
+        // writes through an exposed layer aren't seen, so it has to stay in the composition
+        l.empty = !l.exposed;
+        l.dirty = true;
     }
 
     /**
-     * Draw a line from (x1,y1) to (x2,y2) with a specific color.
-     * @param x1 x-coordinate of the start point
-     * @param y1 y-coordinate of the start point
-     * @param x2 x-coordinate of the end point
-     * @param y2 y-coordinate of the end point
-     * @param r red value of the line
-     * @param g green value of the line
-     * @param b blue value of the line
+     * Check if all pixels of a layer are off.
+     * @param layer layer id, see MatrixLayer
+     * @return bool
      */
-    void line(int x1, int y1, int x2, int y2, int r, int g, int b)
+    bool is_layer_empty(int layer)
     {
-        this->line(x1, y1, x2, y2, Color(r, g, b));
+        return layer < 0 || layer >= LAYER_COUNT || layers[layer].empty;
     }
 
     /**
-     * Draw a number at a specific position with a specific color.
-     * The origin of all numbers is bottom left.
-     * You most likely won't fit more than three digits on the screen.
-     * Utilize for example scrolling to display more digits.
-     * @param x x-coordinate of the position
-     * @param y y-coordinate of the position
-     * @param n number to be drawn
-     * @param color color of the number
-     * @param gap (optional) gap between the digits
+     * Change how a layer is drawn on top of the layers below.
+     * @param layer layer id, see MatrixLayer
+     * @param opacity opacity from 0 (invisible) to 255 (opaque)
+     * @param blend blend mode, see BlendMode
      */
-    void number(int x, int y, unsigned int n, uint32_t color, int gap = 1)
+    void set_layer_blend(int layer, int opacity, int blend = BLEND_NORMAL)
     {
-        int amount_of_digits = this->count_digits(n);
-        int needed_space = amount_of_digits * 3 + (amount_of_digits - 1) * gap;
-        if ((needed_space + x) > 12)
+        if (layer < 0 || layer >= LAYER_COUNT || blend < BLEND_NORMAL || blend > BLEND_MULTIPLY)
         {
             std::cout << "Out of range" << std::endl;
+            return;
+        }
+        Layer& l = layers[layer];
+        l.opacity = std::clamp(opacity, 0, 255);
+        l.blend = static_cast<BlendMode>(blend);
+        l.dirty = true;
+    }
 
+    /**
+     * Show or hide a layer.
+     * @param layer layer id, see MatrixLayer
+     * @param visible bool
+     */
+    void set_layer_visible(int layer, bool visible)
+    {
+        if (layer < 0 || layer >= LAYER_COUNT)
+        {
+            std::cout << "Out of range" << std::endl;
             return;
         }
+        layers[layer].visible = visible;
+        layers[layer].dirty = true;
+    }
 
-        if (n == 0)
+    /**
+     * Switch a layer between colors and palette indices. While a layer is indexed,
+     * the color of all drawing functions is the palette index. Clears the layer.
+     * The mode of an exposed layer can't change until the layers are reset, since the
+     * program may still hold the pixels.
+     * @param layer layer id, see MatrixLayer
+     * @param bits 0 for colors, 4 for a palette with 16 colors, 8 for 256 colors
+     */
+    void set_layer_indexed(int layer, int bits)
+    {
+        if (layer < 0 || layer >= LAYER_COUNT || (bits != 0 && bits != 4 && bits != 8))
         {
-            digit(x, y, n, color);
+            std::cout << "Out of range" << std::endl;
+            return;
         }
-        int pos = needed_space - 3;
-        while (n > 0)
+        Layer& l = layers[layer];
+        if (l.index_bits == bits)
         {
-            digit(x + pos, y, n % 10, color);
-            n /= 10;
-            pos -= 3 + gap;
+            return;
+        }
+        if (l.exposed)
+        {
+            std::cout << "Layer is exposed" << std::endl;
+            return;
+        }
+        l.index_bits = bits;
+        if (bits)
+        {
+            l.palette.assign(1 << bits, 0);
+            l.indices.assign(pixel_count, 0);
+            std::vector<uint32_t>().swap(l.pixels);
         }
+        else
+        {
+            std::vector<uint32_t>().swap(l.palette);
+            std::vector<uint8_t>().swap(l.indices);
+            l.pixels.assign(pixel_count, 0);
+        }
+        l.empty = true;
+        l.dirty = true;
     }
 
     /**
-     * Draw a number at a specific position with a specific color.
-     * The origin of all numbers is bottom left.
-     * You most likely won't fit more than three digits on the screen.
-     * Utilize for example scrolling to display more digits.
-     * @param x x-coordinate of the position
-     * @param y y-coordinate of the position
-     * @param n number to be drawn
-     * @param r red value of the number
-     * @param g green value of the number
-     * @param b blue value of the number
-     * @param gap (optional) gap between the digits
+     * Get direct access to the pixels of a layer, so a program can read and write them
+     * without a call per pixel. A color layer is handed out as 4 bytes per pixel in
+     * little endian order (blue, green, red, unused), an indexed layer as one index per byte.
+     * Since writes can't be tracked, the layer is composed with every frame until the
+     * layers are reset, even right after it was cleared. The pointer stays valid until then, the mode of an exposed
+     * layer can't change.
+     * @param layer layer id, see MatrixLayer
+     * @param size receives the size of the buffer in bytes
+     * @return pointer to the pixels or nullptr if the layer is invalid
      */
-    void number(int x, int y, unsigned int n, int r, int g, int b, int gap = 1)
+    uint8_t* expose_layer(int layer, int& size)
     {
-        this->number(x, y, n, Color(r, g, b), gap);
+        if (layer < 0 || layer >= LAYER_COUNT)
+        {
+            std::cout << "Out of range" << std::endl;
+            size = 0;
+            return nullptr;
+        }
+        Layer& l = layers[layer];
+        l.exposed = true;
+        l.empty = false;
+        if (l.index_bits)
+        {
+            size = static_cast<int>(l.indices.size());
+            return l.indices.data();
+        }
+        size = static_cast<int>(l.pixels.size() * sizeof(uint32_t));
+        return reinterpret_cast<uint8_t*>(l.pixels.data());
     }
 
     /**
-     *  Draw a digit at a specific position with a specific color.
-     * The origin of all digits is bottom left.
-     * You most likely won't fit more than three digits on the screen.
-     * Utilize for example scrolling to display more digits.
-     * @param x x-coordinate of the position
-     * @param y y-coordinate of the position
-     * @param n number to be drawn
-     * @param r red value of the number
-     * @param g green value of the number
-     * @param b blue value of the number
+     * Read the colors of a layer in matrix order, without marking it as exposed.
+     * @param layer layer id, see MatrixLayer
+     * @return pointer to the colors or nullptr if the layer is invalid or indexed
      */
-
-    void digit(int x, int y, int n, int r, int g, int b)
+    const uint32_t* get_layer_pixels(int layer)
     {
-        this->digit(x, y, n, Color(r, g, b));
+        if (layer < 0 || layer >= LAYER_COUNT || layers[layer].index_bits)
+        {
+            return nullptr;
+        }
+        return layers[layer].pixels.data();
     }
 
     /**
-     *  Draw a digit at a specific position with a specific color.
-     * The origin of all digits is bottom left.
-     * @param x x-coordinate of the position
-     * @param y y-coordinate of the position
-     * @param n number to be drawn
-     * @param color color of the number
+     * Draw a complete frame onto the active layer. Pixels which are off (0) leave the layer untouched.
+     * @param colors colors of all pixels in matrix order
      */
-    void digit(const int x, const int y, const int n, uint32_t color)
+    void overlay(const uint32_t* colors)
+    {
+        Layer& layer = canvas();
+        for (int i = 0; i < pixel_count; i++)
+        {
+            if (colors[i])
+            {
+                layer.put(i, colors[i]);
+            }
+        }
+    }
+
+    /**
+     * Change a color of the palette of an indexed layer.
+     * Every pixel using this index changes with the next frame.
+     * @param layer layer id, see MatrixLayer
+     * @param index palette index
+     * @param color new color
+     */
+    void set_palette(int layer, int index, uint32_t color)
+    {
+        if (layer < 0 || layer >= LAYER_COUNT || index < 0 || index >= static_cast<int>(layers[layer].palette.size()))
+        {
+            std::cout << "Out of range" << std::endl;
+            return;
+        }
+        layers[layer].palette[index] = color;
+        layers[layer].dirty = true;
+    }
+
+    /**
+     * Rotate a range of the palette of an indexed layer, for color cycling effects
+     * like water or fire. Costs the same, no matter how many pixels use the colors.
+     * @param layer layer id, see MatrixLayer
+     * @param first first index of the range
+     * @param last last index of the range
+     * @param steps (optional) amount of positions to rotate, negative values rotate backwards
+     */
+    void cycle_palette(int layer, int first, int last, int steps = 1)
+    {
+        if (layer < 0 || layer >= LAYER_COUNT || first < 0 || first >= last ||
+            last >= static_cast<int>(layers[layer].palette.size()))
+        {
+            std::cout << "Out of range" << std::endl;
+            return;
+        }
+        std::vector<uint32_t>& palette = layers[layer].palette;
+        const int length = last - first + 1;
+        steps %= length;
+        if (steps < 0)
+        {
+            steps += length;
+        }
+        std::rotate(palette.begin() + first, palette.begin() + first + length - steps, palette.begin() + last + 1);
+        layers[layer].dirty = true;
+    }
+
+    /**
+     * Clear all layers, reset their settings and select the game layer.
+     */
+    void reset_layers()
+    {
+        for (int i = 0; i < LAYER_COUNT; i++)
+        {
+            // the program which held the pixels is gone
+            layers[i].exposed = false;
+            set_layer_indexed(i, 0);
+            clear_layer(i);
+            set_layer_blend(i, 255, BLEND_NORMAL);
+            set_layer_visible(i, true);
+        }
+        active_layer = LAYER_GAME;
+    }
+
+    /**
+     * Draw a line from (x1,y1) to (x2,y2) with a specific color.
+     * @param x1 x-coordinate of the start point
+     * @param y1 y-coordinate of the start point
+     * @param x2 x-coordinate of the end point
+     * @param y2 y-coordinate of the end point
+     * @param color color of the line
+     */
+
+    void line(int x1, int y1, int x2, int y2, uint32_t color)
+    {
+        if (y1 == y2)
+        {
+            this->hline(x1, x2, y1, color);
+            return;
+        }
+        if (x1 == x2)
+        {
+            this->vline(x1, y1, y2, color);
+            return;
+        }
+
+        int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+        int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+        int err = dx + dy, e2; /* error value e_xy */
+
+        for (;;)
+        {
+            this->set(x1, y1, color);
+            if (x1 == x2 && y1 == y2)
+                break;
+            e2 = 2 * err;
+            if (e2 >= dy)
+            {
+                err += dy;
+                x1 += sx;
+            } /* e_xy+e_x > 0 */
+            if (e2 <= dx)
+            {
+                err += dx;
+                y1 += sy;
+            } /* e_xy+e_y < 0 */
+        }
+    }
+
+    /**
+     * Draw a horizontal line from (x1,y) to (x2,y) with a specific color.
+     * Parts outside of the matrix are skipped.
+     * @param x1 x-coordinate of the start point
+     * @param x2 x-coordinate of the end point
+     * @param y y-coordinate of the line
+     * @param color color of the line
+     */
+    void hline(int x1, int x2, int y, uint32_t color)
+    {
+        if (x1 > x2)
+        {
+            std::swap(x1, x2);
+        }
+        this->fill_rect(x1, y, x2 - x1 + 1, 1, color);
+    }
+
+    /**
+     * Draw a vertical line from (x,y1) to (x,y2) with a specific color.
+     * Parts outside of the matrix are skipped.
+     * @param x x-coordinate of the line
+     * @param y1 y-coordinate of the start point
+     * @param y2 y-coordinate of the end point
+     * @param color color of the line
+     */
+    void vline(int x, int y1, int y2, uint32_t color)
+    {
+        if (y1 > y2)
+        {
+            std::swap(y1, y2);
+        }
+        this->fill_rect(x, y1, 1, y2 - y1 + 1, color);
+    }
+
+    /**
+     * Fill a rectangle with a specific color. The rectangle is clipped to the matrix
+     * once and then written row by row.
+     * @param x x-coordinate of the bottom left corner
+     * @param y y-coordinate of the bottom left corner
+     * @param width width of the rectangle
+     * @param height height of the rectangle
+     * @param color color of the rectangle
+     */
+    void fill_rect(int x, int y, int width, int height, uint32_t color)
+    {
+        const int x1 = std::max(x, 0);
+        const int y1 = std::max(y, 0);
+        const int x2 = std::min(x + width, this->width);
+        const int y2 = std::min(y + height, this->height);
+        if (x1 >= x2 || y1 >= y2)
+        {
+            return;
+        }
+
+        Layer& target = canvas();
+        for (int row = y1; row < y2; row++)
+        {
+            target.fill(row * this->width + x1, x2 - x1, color);
+        }
+    }
+
+    /**
+     * Check if a sprite of this size can be registered. The spans store columns as 16 bit,
+     * the amount of pixels is capped by MAX_SPRITE_PIXELS.
+     * @param width width of the bitmap
+     * @param height height of the bitmap
+     * @return bool
+     */
+    static bool is_sprite_size_valid(long long width, long long height)
+    {
+        return width > 0 && height > 0 && width <= UINT16_MAX && width * height <= MAX_SPRITE_PIXELS;
+    }
+
+    /**
+     * Register a bitmap which can be drawn with blit.
+     * @param width width of the bitmap
+     * @param height height of the bitmap
+     * @param pixels width * height colors, row by row starting bottom left
+     * @param transparent color which is not drawn
+     * @param id (optional) id of a sprite to replace, -1 to add a new sprite
+     * @return id of the sprite or -1 if the size or the id is invalid
+     */
+    int add_sprite(int width, int height, const uint32_t* pixels, uint32_t transparent = 0, int id = -1)
+    {
+        if (!is_sprite_size_valid(width, height) || id < -1 || id >= static_cast<int>(sprites.size()))
+        {
+            return -1;
+        }
+        Sprite sprite;
+        sprite.width = width;
+        sprite.height = height;
+        sprite.pixels.assign(pixels, pixels + width * height);
+        sprite.row_spans.reserve(height + 1);
+        for (int row = 0; row < height; row++)
+        {
+            sprite.row_spans.push_back(sprite.spans.size());
+            const uint32_t* line = pixels + row * width;
+            int col = 0;
+            while (col < width)
+            {
+                if (line[col] == transparent)
+                {
+                    col++;
+                    continue;
+                }
+                const int start = col;
+                while (col < width && line[col] != transparent)
+                {
+                    col++;
+                }
+                sprite.spans.push_back(start);
+                sprite.spans.push_back(col - start);
+            }
+        }
+        sprite.row_spans.push_back(sprite.spans.size());
+        if (id >= 0)
+        {
+            sprites[id] = std::move(sprite);
+            return id;
+        }
+        sprites.push_back(std::move(sprite));
+        return static_cast<int>(sprites.size()) - 1;
+    }
+
+    /**
+     * Register a palette indexed bitmap which can be drawn with blit.
+     * The indices are resolved once, drawing costs the same as for a color bitmap.
+     * @param width width of the bitmap
+     * @param height height of the bitmap
+     * @param indices width * height palette indices, row by row starting bottom left
+     * @param palette colors of the palette
+     * @param palette_size number of colors in the palette
+     * @param transparent index which is not drawn, -1 to draw all pixels
+     * @return id of the sprite or -1 if the size or an index is invalid
+     */
+    int add_sprite(int width, int height, const uint8_t* indices, const uint32_t* palette, int palette_size,
+                   int transparent = -1)
+    {
+        if (!is_sprite_size_valid(width, height))
+        {
+            return -1;
+        }
+        // pick a key which is not used by any opaque color of the palette
+        uint32_t key = 0;
+        while (std::find(palette, palette + palette_size, key) != palette + palette_size)
+        {
+            key++;
+        }
+        std::vector<uint32_t> pixels(width * height);
+        for (int i = 0; i < width * height; i++)
+        {
+            if (indices[i] == transparent)
+            {
+                pixels[i] = key;
+            }
+            else if (indices[i] < palette_size)
+            {
+                pixels[i] = palette[indices[i]];
+            }
+            else
+            {
+                return -1;
+            }
+        }
+        return this->add_sprite(width, height, pixels.data(), key);
+    }
+
+    /**
+     * Remove all registered sprites. The ids are reused afterwards.
+     */
+    void clear_sprites()
+    {
+        sprites.clear();
+    }
+
+    /**
+     * Draw a sprite. It is clipped to the matrix and may be mirrored.
+     * @param id id of the sprite
+     * @param x x-coordinate of the bottom left corner
+     * @param y y-coordinate of the bottom left corner
+     * @param flip combination of SpriteFlip flags
+     */
+    void blit(int id, int x, int y, int flip = FLIP_NONE)
+    {
+        if (id < 0 || id >= static_cast<int>(sprites.size()))
+        {
+            std::cout << "Out of range" << std::endl;
+            return;
+        }
+        const Sprite& sprite = sprites[id];
+        if (x >= this->width || y >= this->height || x + sprite.width <= 0 || y + sprite.height <= 0)
+        {
+            return;
+        }
+
+        Layer& target = canvas();
+        for (int row = 0; row < sprite.height; row++)
+        {
+            const int ty = y + ((flip & FLIP_Y) ? sprite.height - 1 - row : row);
+            if (ty < 0 || ty >= this->height)
+            {
+                continue;
+            }
+            const uint32_t* line = sprite.pixels.data() + row * sprite.width;
+            const int out = ty * this->width;
+            for (uint32_t s = sprite.row_spans[row]; s < sprite.row_spans[row + 1]; s += 2)
+            {
+                const int start = sprite.spans[s];
+                const int length = sprite.spans[s + 1];
+                // columns of the sprite which end up inside the matrix
+                int first = start;
+                int last = start + length;
+                if (flip & FLIP_X)
+                {
+                    first = std::max(first, x + sprite.width - this->width);
+                    last = std::min(last, x + sprite.width);
+                    for (int col = first; col < last; col++)
+                    {
+                        target.put(out + x + sprite.width - 1 - col, line[col]);
+                    }
+                }
+                else
+                {
+                    first = std::max(first, -x);
+                    last = std::min(last, this->width - x);
+                    if (first < last)
+                    {
+                        target.copy(out + x + first, line + first, last - first);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Get the width of a text drawn with the text function.
+     * @param text text to be measured
+     * @param gap (optional) gap between the characters
+     * @return width in pixels
+     */
+    static int text_width(const std::string& text, int gap = 1)
+    {
+        if (text.empty())
+        {
+            return 0;
+        }
+        const int length = static_cast<int>(text.size());
+        return length * font::GLYPH_WIDTH + (length - 1) * gap;
+    }
+
+    /**
+     * Draw a text at a specific position with a specific color.
+     * The origin of the text is bottom left, every character is 3x5 pixels.
+     * For texts which are wider than the matrix @see text_strip.
+     * @param x x-coordinate of the position
+     * @param y y-coordinate of the position
+     * @param text text to be drawn
+     * @param color color of the text
+     * @param gap (optional) gap between the characters
+     */
+    void text(int x, int y, const std::string& text, uint32_t color, int gap = 1)
+    {
+        if (y >= this->height || y + font::GLYPH_HEIGHT <= 0 || x >= this->width)
+        {
+            return;
+        }
+        Layer& target = canvas();
+        for (const char c : text)
+        {
+            if (x + font::GLYPH_WIDTH > 0)
+            {
+                this->glyph(this->width, this->height, x, y, font::glyph(c), [&](int pixel)
+                {
+                    target.put(pixel, color);
+                });
+            }
+            x += font::GLYPH_WIDTH + gap;
+            if (x >= this->width)
+            {
+                break;
+            }
+        }
+    }
+
+    /**
+     * Render a text once into a sprite, which can be scrolled with marquee
+     * or drawn with blit. Useful for long texts which are shown every frame.
+     * A text which changes, like a score, should replace its strip instead of adding a new one.
+     * @param text text to be rendered
+     * @param color color of the text
+     * @param gap (optional) gap between the characters
+     * @param id (optional) id of a sprite to replace, -1 to add a new sprite
+     * @return id of the sprite or -1 if the text is empty, too long or the id is invalid
+     */
+    int text_strip(const std::string& text, uint32_t color, int gap = 1, int id = -1)
+    {
+        const long long length = static_cast<long long>(text.size());
+        if (length == 0 || color == 0 ||
+            !is_sprite_size_valid(length * font::GLYPH_WIDTH + (length - 1) * gap, font::GLYPH_HEIGHT))
+        {
+            return -1;
+        }
+        const int strip_width = text_width(text, gap);
+        std::vector<uint32_t> pixels(strip_width * font::GLYPH_HEIGHT, 0);
+        int x = 0;
+        for (const char c : text)
+        {
+            this->glyph(strip_width, font::GLYPH_HEIGHT, x, 0, font::glyph(c), [&](int pixel)
+            {
+                pixels[pixel] = color;
+            });
+            x += font::GLYPH_WIDTH + gap;
+        }
+        return this->add_sprite(strip_width, font::GLYPH_HEIGHT, pixels.data(), 0, id);
+    }
+
+    /**
+     * Draw a window of a sprite which scrolls endlessly, like a news ticker.
+     * Only the pixels within the window are touched.
+     * @param id id of the sprite, usually created with text_strip
+     * @param x x-coordinate of the bottom left corner of the window
+     * @param y y-coordinate of the bottom left corner of the window
+     * @param width width of the window
+     * @param offset scroll position, the column of the sprite shown at the left of the window
+     * @param spacing (optional) empty columns between the end of the sprite and its repetition
+     */
+    void marquee(int id, int x, int y, int width, int offset, int spacing = 3)
+    {
+        if (id < 0 || id >= static_cast<int>(sprites.size()))
+        {
+            std::cout << "Out of range" << std::endl;
+            return;
+        }
+        const Sprite& sprite = sprites[id];
+        const int period = sprite.width + std::max(spacing, 0);
+        offset %= period;
+        if (offset < 0)
+        {
+            offset += period;
+        }
+        const int min_x = std::max(x, 0);
+        const int max_x = std::min(x + width, this->width);
+        if (min_x >= max_x || y >= this->height || y + sprite.height <= 0)
+        {
+            return;
+        }
+        Layer& target = canvas();
+        for (int left = x - offset; left < max_x; left += period)
+        {
+            this->sprite_columns(target, sprite, left, y, min_x, max_x);
+        }
+    }
+
+    /**
+     * Draw a line from (x1,y1) to (x2,y2) with a specific color.
+     * @param x1 x-coordinate of the start point
+     * @param y1 y-coordinate of the start point
+     * @param x2 x-coordinate of the end point
+     * @param y2 y-coordinate of the end point
+     * @param r red value of the line
+     * @param g green value of the line
+     * @param b blue value of the line
+     */
+    void line(int x1, int y1, int x2, int y2, int r, int g, int b)
+    {
+        this->line(x1, y1, x2, y2, clamped_color(r, g, b));
+    }
+
+    /**
+     * Draw a number at a specific position with a specific color.
+     * The origin of all numbers is bottom left.
+     * You most likely won't fit more than three digits on the screen.
+     * Utilize for example scrolling to display more digits.
+     * @param x x-coordinate of the position
+     * @param y y-coordinate of the position
+     * @param n number to be drawn
+     * @param color color of the number
+     * @param gap (optional) gap between the digits
+     */
+    void number(int x, int y, unsigned int n, uint32_t color, int gap = 1)
+    {
+        int amount_of_digits = this->count_digits(n);
+        int needed_space = amount_of_digits * 3 + (amount_of_digits - 1) * gap;
+        if ((needed_space + x) > width)
+        {
+            std::cout << "Out of range" << std::endl;
+
+            return;
+        }
+
+        if (n == 0)
+        {
+            digit(x, y, n, color);
+        }
+        int pos = needed_space - 3;
+        while (n > 0)
+        {
+            digit(x + pos, y, n % 10, color);
+            n /= 10;
+            pos -= 3 + gap;
+        }
+    }
+
+    /**
+     * Draw a number at a specific position with a specific color.
+     * The origin of all numbers is bottom left.
+     * You most likely won't fit more than three digits on the screen.
+     * Utilize for example scrolling to display more digits.
+     * @param x x-coordinate of the position
+     * @param y y-coordinate of the position
+     * @param n number to be drawn
+     * @param r red value of the number
+     * @param g green value of the number
+     * @param b blue value of the number
+     * @param gap (optional) gap between the digits
+     */
+    void number(int x, int y, unsigned int n, int r, int g, int b, int gap = 1)
+    {
+        this->number(x, y, n, clamped_color(r, g, b), gap);
+    }
+
+    /**
+     *  Draw a digit at a specific position with a specific color.
+     * The origin of all digits is bottom left.
+     * You most likely won't fit more than three digits on the screen.
+     * Utilize for example scrolling to display more digits.
+     * @param x x-coordinate of the position
+     * @param y y-coordinate of the position
+     * @param n number to be drawn
+     * @param r red value of the number
+     * @param g green value of the number
+     * @param b blue value of the number
+     */
+
+    void digit(int x, int y, int n, int r, int g, int b)
+    {
+        this->digit(x, y, n, clamped_color(r, g, b));
+    }
+
+    /**
+     *  Draw a digit at a specific position with a specific color.
+     * The origin of all digits is bottom left.
+     * @param x x-coordinate of the position
+     * @param y y-coordinate of the position
+     * @param n number to be drawn
+     * @param color color of the number
+     */
+    void digit(const int x, const int y, const int n, uint32_t color)
     {
         switch (n)
         {
         case 0:
-            this->number_segment(x, y, 0, color);
-            this->number_segment(x, y, 1, color);
-            this->number_segment(x, y, 2, color);
-            this->number_segment(x, y, 3, color);
-            this->number_segment(x, y, 4, color);
-            this->number_segment(x, y, 5, color);
-            break;
+            this->number_segment(x, y, 0, color);
+            this->number_segment(x, y, 1, color);
+            this->number_segment(x, y, 2, color);
+            this->number_segment(x, y, 3, color);
+            this->number_segment(x, y, 4, color);
+            this->number_segment(x, y, 5, color);
+            break;
+        case 1:
+            this->number_segment(x, y, 1, color);
+            this->number_segment(x, y, 2, color);
+            break;
+        case 2:
+            this->number_segment(x, y, 0, color);
+            this->number_segment(x, y, 1, color);
+            this->number_segment(x, y, 3, color);
+            this->number_segment(x, y, 4, color);
+            this->number_segment(x, y, 6, color);
+            break;
+        case 3:
+            this->number_segment(x, y, 0, color);
+            this->number_segment(x, y, 1, color);
+            this->number_segment(x, y, 2, color);
+            this->number_segment(x, y, 3, color);
+            this->number_segment(x, y, 6, color);
+            break;
+        case 4:
+            this->number_segment(x, y, 1, color);
+            this->number_segment(x, y, 2, color);
+            this->number_segment(x, y, 5, color);
+            this->number_segment(x, y, 6, color);
+            break;
+        case 5:
+            this->number_segment(x, y, 0, color);
+            this->number_segment(x, y, 2, color);
+            this->number_segment(x, y, 3, color);
+            this->number_segment(x, y, 5, color);
+            this->number_segment(x, y, 6, color);
+            break;
+        case 6:
+            this->number_segment(x, y, 0, color);
+            this->number_segment(x, y, 2, color);
+            this->number_segment(x, y, 3, color);
+            this->number_segment(x, y, 4, color);
+            this->number_segment(x, y, 5, color);
+            this->number_segment(x, y, 6, color);
+            break;
+        case 7:
+            this->number_segment(x, y, 0, color);
+            this->number_segment(x, y, 1, color);
+            this->number_segment(x, y, 2, color);
+            break;
+        case 8:
+            this->number_segment(x, y, 0, color);
+            this->number_segment(x, y, 1, color);
+            this->number_segment(x, y, 2, color);
+            this->number_segment(x, y, 3, color);
+            this->number_segment(x, y, 4, color);
+            this->number_segment(x, y, 5, color);
+            this->number_segment(x, y, 6, color);
+            break;
+        case 9:
+            this->number_segment(x, y, 0, color);
+            this->number_segment(x, y, 1, color);
+            this->number_segment(x, y, 2, color);
+            this->number_segment(x, y, 5, color);
+            this->number_segment(x, y, 6, color);
+            break;
+        default:
+            std::cout << "Out of range" << std::endl;
+
+            break;
+        }
+    }
+
+    /**
+     * Draw a number segment at a specific position with a specific color.
+     * You probably want to use the @see digit function instead.
+     * @param x x-coordinate of the position
+     * @param y y-coordinate of the position
+     * @param s number segment to be drawn
+     * @param color color of the number segment
+     */
+    void number_segment(int x, int y, int s, uint32_t color)
+    {
+        switch (s)
+        {
+        case 0:
+            set(x, y + 4, color);
+            set(x + 1, y + 4, color);
+            set(x + 2, y + 4, color);
+            break;
+        case 1:
+            set(x + 2, y + 4, color);
+            set(x + 2, y + 3, color);
+            set(x + 2, y + 2, color);
+            break;
+        case 2:
+            set(x + 2, y + 2, color);
+            set(x + 2, y + 1, color);
+            set(x + 2, y, color);
+            break;
+        case 3:
+            set(x, y, color);
+            set(x + 1, y, color);
+            set(x + 2, y, color);
+            break;
+        case 4:
+            set(x, y, color);
+            set(x, y + 1, color);
+            set(x, y + 2, color);
+            break;
+        case 5:
+            set(x, y + 2, color);
+            set(x, y + 3, color);
+            set(x, y + 4, color);
+            break;
+        case 6:
+            set(x, y + 2, color);
+            set(x + 1, y + 2, color);
+            set(x + 2, y + 2, color);
+            break;
+        default:
+            std::cout << "Out of range" << std::endl;
+
+            break;
+        }
+    }
+
+    /**
+     * Draw a rectangle at a specific position with a specific color.
+     * @param x x-coordinate of the position
+     * @param y y-coordinate of the position
+     * @param width width of the rectangle
+     * @param height height of the rectangle
+     * @param color color of the rectangle
+     * @param filled (optional) if true, the rectangle will be filled
+     */
+    void rect(int x, int y, int width, int height, uint32_t color, bool filled = false)
+    {
+        if (filled)
+        {
+            this->fill_rect(x, y, width, height, color);
+            return;
+        }
+        width--;
+        height--;
+        this->hline(x, x + width, y, color);
+        this->hline(x, x + width, y + height, color);
+        this->vline(x, y, y + height, color);
+        this->vline(x + width, y, y + height, color);
+    }
+
+    /**
+     * Draw a rectangle at a specific position with a specific color.
+     * @param x x-coordinate of the position
+     * @param y y-coordinate of the position
+     * @param width width of the rectangle
+     * @param height height of the rectangle
+     * @param r red value of the rectangle
+     * @param g green value of the rectangle
+     * @param b blue value of the rectangle
+     * @param filled (optional) if true, the rectangle will be filled
+     */
+    void rect(int x, int y, int width, int height, int r, int g, int b, bool filled = false)
+    {
+        this->rect(x, y, width, height, clamped_color(r, g, b), filled);
+    }
+
+    /**
+     * Draw a circle at a specific position with a specific color.
+     * Uses the integer midpoint algorithm, parts outside of the matrix are skipped.
+     * @param x x-coordinate of the position
+     * @param y y-coordinate of the position
+     * @param radius radius of the circle
+     * @param color color of the circle
+     * @param filled (optional) if true, the circle will be filled
+     */
+    void circle(int x, int y, int radius, uint32_t color, bool filled = true)
+    {
+        if (radius < 0)
+        {
+            return;
+        }
+
+        // the bounds are only checked per pixel if the circle is not completely on the matrix
+        const bool inside = x - radius >= 0 && x + radius < width && y - radius >= 0 && y + radius < height;
+        int dx = radius;
+        int dy = 0;
+        int err = 1 - radius;
+        while (dx >= dy)
+        {
+            if (filled)
+            {
+                this->hline(x - dx, x + dx, y + dy, color);
+                this->hline(x - dx, x + dx, y - dy, color);
+                this->hline(x - dy, x + dy, y + dx, color);
+                this->hline(x - dy, x + dy, y - dx, color);
+            }
+            else
+            {
+                this->circle_points(x, y, dx, dy, color, inside);
+            }
+
+            dy++;
+            if (err < 0)
+            {
+                err += 2 * dy + 1;
+            }
+            else
+            {
+                dx--;
+                err += 2 * (dy - dx) + 1;
+            }
+        }
+    }
+
+    /**
+     * Draw a circle at a specific position with a specific color.
+     * @param x x-coordinate of the position
+     * @param y y-coordinate of the position
+     * @param radius radius of the circle
+     * @param r red value of the circle
+     * @param g green value of the circle
+     * @param b blue value of the circle
+     * @param filled (optional) if true, the circle will be filled
+     */
+
+    void circle(int x, int y, int radius, int r, int g, int b, bool filled = false)
+    {
+        this->circle(x, y, radius, clamped_color(r, g, b), filled);
+    }
+
+    /**
+     * Create a color from red, green and blue values.
+     * Useful for most helper functions.
+     * @param r red value
+     * @param g green value
+     * @param b blue value
+     */
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b)
+    {
+        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+
+    /**
+     * Create a color from red, green and blue values, clamping each to 0 - 255.
+     * Used by the r/g/b overloads, so an out of range value saturates instead of wrapping.
+     * @param r red value
+     * @param g green value
+     * @param b blue value
+     * @return color
+     */
+    static uint32_t clamped_color(int r, int g, int b)
+    {
+        return Color(std::clamp(r, 0, 255), std::clamp(g, 0, 255), std::clamp(b, 0, 255));
+    }
+
+    /**
+     * Blend two colors. All channels are interpolated at once, two channels share
+     * one multiplication.
+     * @param from color at amount 0
+     * @param to color at amount 256
+     * @param amount mix from 0 to 256
+     * @return mixed color
+     */
+    static uint32_t lerp_color(uint32_t from, uint32_t to, int amount)
+    {
+        const uint32_t a = std::clamp(amount, 0, 256);
+        // red and blue are 16 bit apart, so they don't overlap while multiplying
+        const uint32_t rb = ((from & 0xFF00FF) * (256 - a) + (to & 0xFF00FF) * a) >> 8 & 0xFF00FF;
+        const uint32_t g = ((from & 0x00FF00) * (256 - a) + (to & 0x00FF00) * a) >> 8 & 0x00FF00;
+        return rb | g;
+    }
+
+    /**
+     * Create a color from hue, saturation and value. Only uses integer math.
+     * @param hue hue in degrees, wraps around
+     * @param saturation saturation from 0 (grey) to 255
+     * @param value brightness from 0 to 255
+     * @return color
+     */
+    static uint32_t hsv(int hue, int saturation, int value)
+    {
+        hue = (hue % 360 + 360) % 360;
+        saturation = std::clamp(saturation, 0, 255);
+        value = std::clamp(value, 0, 255);
+        const int sector = hue / 60;
+        // position within the sector from 0 to 255
+        const int f = (hue % 60) * 255 / 60;
+        const uint8_t v = value;
+        const uint8_t p = value * (255 - saturation) / 255;
+        const uint8_t q = value * (255 * 255 - saturation * f) / (255 * 255);
+        const uint8_t t = value * (255 * 255 - saturation * (255 - f)) / (255 * 255);
+        switch (sector)
+        {
+        case 0:
+            return Color(v, t, p);
         case 1:
-            this->number_segment(x, y, 1, color);
-            this->number_segment(x, y, 2, color);
-            break;
+            return Color(q, v, p);
         case 2:
-            this->number_segment(x, y, 0, color);
-            this->number_segment(x, y, 1, color);
-            this->number_segment(x, y, 3, color);
-            this->number_segment(x, y, 4, color);
-            this->number_segment(x, y, 6, color);
-            break;
+            return Color(p, v, t);
         case 3:
-            this->number_segment(x, y, 0, color);
-            this->number_segment(x, y, 1, color);
-            this->number_segment(x, y, 2, color);
-            this->number_segment(x, y, 3, color);
-            this->number_segment(x, y, 6, color);
-            break;
+            return Color(p, q, v);
         case 4:
-            this->number_segment(x, y, 1, color);
-            this->number_segment(x, y, 2, color);
-            this->number_segment(x, y, 5, color);
-            this->number_segment(x, y, 6, color);
-            break;
-        case 5:
-            this->number_segment(x, y, 0, color);
-            this->number_segment(x, y, 2, color);
-            this->number_segment(x, y, 3, color);
-            this->number_segment(x, y, 5, color);
-            this->number_segment(x, y, 6, color);
-            break;
-        case 6:
-            this->number_segment(x, y, 0, color);
-            this->number_segment(x, y, 2, color);
-            this->number_segment(x, y, 3, color);
-            this->number_segment(x, y, 4, color);
-            this->number_segment(x, y, 5, color);
-            this->number_segment(x, y, 6, color);
-            break;
-        case 7:
-            this->number_segment(x, y, 0, color);
-            this->number_segment(x, y, 1, color);
-            this->number_segment(x, y, 2, color);
-            break;
-        case 8:
-            this->number_segment(x, y, 0, color);
-            this->number_segment(x, y, 1, color);
-            this->number_segment(x, y, 2, color);
-            this->number_segment(x, y, 3, color);
-            this->number_segment(x, y, 4, color);
-            this->number_segment(x, y, 5, color);
-            this->number_segment(x, y, 6, color);
-            break;
-        case 9:
-            this->number_segment(x, y, 0, color);
-            this->number_segment(x, y, 1, color);
-            this->number_segment(x, y, 2, color);
-            this->number_segment(x, y, 5, color);
-            this->number_segment(x, y, 6, color);
-            break;
+            return Color(t, p, v);
         default:
+            return Color(v, p, q);
+        }
+    }
+
+    /**
+     * Set the Ticks per Second for each application.
+     * This will adjust the frequency of the game_loop function.
+     * The draw calls won't be affected.
+     * @param tps Ticks per second
+     */
+    void set_tps(float tps)
+    {
+        if (tps > 200)
+        {
+            tps = 200;
+        }
+
+        if (tps < 0)
+        {
+            tps = 0;
+        }
+
+        this->currentTPS = tps;
+    }
+
+    /**
+     * Get the ticks per second for
+     * the current animation
+     * @return Ticks per Second
+     */
+
+    float get_current_tps()
+    {
+        return currentTPS;
+    }
+
+    /**
+     * Get the width of the matrix in pixels.
+     * @return width
+     */
+    int get_width()
+    {
+        return width;
+    }
+
+    /**
+     * Get the height of the matrix in pixels.
+     * @return height
+     */
+    int get_height()
+    {
+        return height;
+    }
+
+    /**
+     * Get the amount of leds of the matrix.
+     * @return amount of leds
+     */
+    int get_pixel_count()
+    {
+        return pixel_count;
+    }
+
+    MatrixGeometry get_geometry()
+    {
+        return geometry;
+    }
+
+    /**
+     * Move the content of the active layer. Whole rows are moved at once,
+     * which is a lot cheaper than drawing the frame again.
+     * @param dx pixels to move to the right, negative values move to the left
+     * @param dy pixels to move up, negative values move down
+     * @param wrap (optional) if true, pixels leaving on one side come back on the other side
+     * @param fill (optional) color of the uncovered pixels if wrap is false
+     */
+    void scroll(int dx, int dy, bool wrap = true, uint32_t fill = 0)
+    {
+        Layer& target = canvas();
+        if (target.index_bits)
+        {
+            this->scroll_pixels(target.indices, dx, dy, wrap,
+                                static_cast<uint8_t>(fill & (target.palette.size() - 1)));
+        }
+        else
+        {
+            this->scroll_pixels(target.pixels, dx, dy, wrap, fill);
+        }
+    }
+
+    /**
+     * Rotate the active layer by 90 degrees. Only possible on square matrices.
+     * @param clockwise (optional) direction of the rotation
+     */
+    void rotate(bool clockwise = true)
+    {
+        if (this->width != this->height)
+        {
+            std::cout << "Only square matrices can be rotated" << std::endl;
+            return;
+        }
+        Layer& target = canvas();
+        // a transposition followed by a mirror is a rotation
+        const int flip = clockwise ? FLIP_Y : FLIP_X;
+        if (target.index_bits)
+        {
+            this->transpose_pixels(target.indices);
+            this->mirror_pixels(target.indices, flip);
+        }
+        else
+        {
+            this->transpose_pixels(target.pixels);
+            this->mirror_pixels(target.pixels, flip);
+        }
+    }
+
+    /**
+     * Mirror the active layer.
+     * @param flip combination of SpriteFlip flags, FLIP_X swaps left and right, FLIP_Y top and bottom
+     */
+    void mirror(int flip)
+    {
+        Layer& target = canvas();
+        if (target.index_bits)
+        {
+            this->mirror_pixels(target.indices, flip);
+        }
+        else
+        {
+            this->mirror_pixels(target.pixels, flip);
+        }
+    }
+
+    /**
+     * Execute a buffer of draw commands. Every command is an operation (see DrawOp)
+     * followed by its arguments. Executing stops at the first invalid operation or
+     * at a command which is cut off by the end of the buffer.
+     * @param commands the command buffer
+     * @param length amount of values in the buffer
+     * @return amount of executed commands
+     */
+    int execute(const int32_t* commands, int length)
+    {
+        int executed = 0;
+        int i = 0;
+        while (i < length)
+        {
+            const int op = commands[i];
+            if (op < OP_SET || op > OP_LAYER || i + DRAW_OP_ARGUMENTS[op] >= length)
+            {
+                break;
+            }
+            const int32_t* a = commands + i + 1;
+            switch (op)
+            {
+            case OP_SET:
+                this->set(a[0], a[1], static_cast<uint32_t>(a[2]), true);
+                break;
+            case OP_LINE:
+                this->line(a[0], a[1], a[2], a[3], a[4]);
+                break;
+            case OP_HLINE:
+                this->hline(a[0], a[1], a[2], a[3]);
+                break;
+            case OP_VLINE:
+                this->vline(a[0], a[1], a[2], a[3]);
+                break;
+            case OP_RECT:
+                this->rect(a[0], a[1], a[2], a[3], a[4], false);
+                break;
+            case OP_RECT_FILLED:
+                this->fill_rect(a[0], a[1], a[2], a[3], a[4]);
+                break;
+            case OP_CIRCLE:
+                this->circle(a[0], a[1], a[2], a[3], false);
+                break;
+            case OP_CIRCLE_FILLED:
+                this->circle(a[0], a[1], a[2], a[3], true);
+                break;
+            case OP_NUMBER:
+                this->number(a[0], a[1], a[2], a[3]);
+                break;
+            case OP_FILL:
+                this->fill(static_cast<uint32_t>(a[0]));
+                break;
+            case OP_CLEAR:
+                this->clear();
+                break;
+            case OP_BLIT:
+                this->blit(a[0], a[1], a[2], a[3]);
+                break;
+            case OP_LAYER:
+                this->set_layer(a[0]);
+                break;
+            default:
+                break;
+            }
+            i += 1 + DRAW_OP_ARGUMENTS[op];
+            executed++;
+        }
+        return executed;
+    }
+
+    /**
+     * Set the brightness of the leds. Applied when a frame is presented, so the
+     * colors drawn by the program stay untouched.
+     * @param brightness brightness from 0 (off) to 255 (full)
+     */
+    void set_brightness(int brightness)
+    {
+        this->brightness = std::clamp(brightness, 0, 255);
+        this->update_lut();
+    }
+
+    /**
+     * Get the brightness of the leds.
+     * @return brightness from 0 to 255
+     */
+    int get_brightness()
+    {
+        return brightness;
+    }
+
+    /**
+     * Set the gamma correction of the leds. Applied when a frame is presented.
+     * Leds are linear, so a gamma around 2.2 makes dark colors look as intended.
+     * @param gamma exponent, 1 disables the correction
+     */
+    void set_gamma(float gamma)
+    {
+        if (!(gamma > 0))
+        {
             std::cout << "Out of range" << std::endl;
+            return;
+        }
+        this->gamma = gamma;
+        this->update_lut();
+    }
+
+    /**
+     * Scale the channels independently, for example to balance the white point of a panel.
+     * Applied when a frame is presented.
+     * @param r scale of the red channel from 0 to 255
+     * @param g scale of the green channel from 0 to 255
+     * @param b scale of the blue channel from 0 to 255
+     */
+    void set_color_correction(int r, int g, int b)
+    {
+        correction[0] = std::clamp(r, 0, 255);
+        correction[1] = std::clamp(g, 0, 255);
+        correction[2] = std::clamp(b, 0, 255);
+        this->update_lut();
+    }
+
+    /**
+     * Publish the next frame. The layers are composed into the back buffer, which is mapped
+     * to strip order into the front buffer that is not visible at the moment, then the front
+     * buffers are swapped. The layers keep their content, so drawing can continue incrementally.
+     * If no layer changed since the last frame, nothing happens.
+     */
+    void present()
+    {
+        bool changed = output_changed;
+        output_changed = false;
+        for (Layer& layer : layers)
+        {
+            changed |= layer.dirty || layer.exposed;
+            layer.dirty = false;
+        }
+        if (!changed)
+        {
+            return;
+        }
+        this->compose();
 
-            break;
+        const uint32_t* previous = front_buffer.load(std::memory_order_relaxed);
+        front_index ^= 1;
+        uint32_t* next = front[front_index].data();
+        for (int i = 0; i < pixel_count; i++)
+        {
+            uint32_t color = back[matrix_map[i]];
+            if (!lut_identity)
+            {
+                color = lut[0][color >> 16 & 0xFF] << 16 | lut[1][color >> 8 & 0xFF] << 8 | lut[2][color & 0xFF];
+            }
+            next[i] = color;
+            if (color != previous[i])
+            {
+                dirty[i] = 1;
+                dirty_rows[i / width] = 1;
+                any_dirty = true;
+            }
         }
+        front_buffer.store(next, std::memory_order_release);
+        frame_id.fetch_add(1, std::memory_order_release);
     }
 
     /**
-     * Draw a number segment at a specific position with a specific color.
-     * You probably want to use the @see digit function instead.
-     * @param x x-coordinate of the position
-     * @param y y-coordinate of the position
-     * @param s number segment to be drawn
-     * @param color color of the number segment
+     * Get the last presented frame in strip order.
+     * The buffer is reused two frames later, see get_frame_id to detect this.
+     * @return pointer to get_pixel_count() colors
      */
-    void number_segment(int x, int y, int s, uint32_t color)
+    const uint32_t* get_leds()
     {
-        switch (s)
+        return front_buffer.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Get the amount of presented frames. A reader of get_leds can compare the id before
+     * and after copying the frame. If it increased by more than one, the buffer was reused.
+     * @return frame id
+     */
+    uint32_t get_frame_id()
+    {
+        return frame_id.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Collect all pixels of the presented frames which changed since the last call and
+     * reset the tracking. The changes are appended as spans of consecutive strip pixels:
+     * [span count, (start index, length, length colors)...]
+     * @param out buffer the changes are written to, it is cleared first
+     * @return number of spans
+     */
+    uint32_t collect_changes(std::vector<uint32_t>& out)
+    {
+        out.clear();
+        out.push_back(0);
+        if (!any_dirty)
         {
-        case 0:
-            set(x, y + 4, color);
-            set(x + 1, y + 4, color);
-            set(x + 2, y + 4, color);
-            break;
-        case 1:
-            set(x + 2, y + 4, color);
-            set(x + 2, y + 3, color);
-            set(x + 2, y + 2, color);
-            break;
-        case 2:
-            set(x + 2, y + 2, color);
-            set(x + 2, y + 1, color);
-            set(x + 2, y, color);
-            break;
-        case 3:
-            set(x, y, color);
-            set(x + 1, y, color);
-            set(x + 2, y, color);
-            break;
-        case 4:
-            set(x, y, color);
-            set(x, y + 1, color);
-            set(x, y + 2, color);
-            break;
-        case 5:
-            set(x, y + 2, color);
-            set(x, y + 3, color);
-            set(x, y + 4, color);
-            break;
-        case 6:
-            set(x, y + 2, color);
-            set(x + 1, y + 2, color);
-            set(x + 2, y + 2, color);
-            break;
-        default:
-            std::cout << "Out of range" << std::endl;
+            return 0;
+        }
 
-            break;
+        const uint32_t* pixels = get_leds();
+        uint32_t spans = 0;
+        for (int row = 0; row < height; row++)
+        {
+            if (!dirty_rows[row])
+            {
+                continue;
+            }
+            dirty_rows[row] = 0;
+
+            int i = row * width;
+            const int row_end = i + width;
+            while (i < row_end)
+            {
+                // pixels which were written but ended up with the exported color are skipped
+                if (!is_changed(i, pixels))
+                {
+                    i++;
+                    continue;
+                }
+                const int start = i;
+                // spans continue into the next row if it has changes as well
+                do
+                {
+                    exported[i] = pixels[i];
+                    i++;
+                }
+                while (i < pixel_count && is_changed(i, pixels));
+                out.push_back(start);
+                out.push_back(i - start);
+                out.insert(out.end(), pixels + start, pixels + i);
+                spans++;
+            }
         }
+        any_dirty = false;
+        out[0] = spans;
+        return spans;
     }
 
     /**
-     * Draw a rectangle at a specific position with a specific color.
-     * @param x x-coordinate of the position
-     * @param y y-coordinate of the position
-     * @param width width of the rectangle
-     * @param height height of the rectangle
-     * @param color color of the rectangle
-     * @param filled (optional) if true, the rectangle will be filled
+     * Check if any pixel changed since the last call to collect_changes.
+     * @return bool
      */
-    void rect(int x, int y, int width, int height, uint32_t color, bool filled = false)
+    bool has_changes()
     {
-        width--;
-        height--;
-        if (filled)
+        return any_dirty;
+    }
+
+private:
+    bool inverse = false;
+    MatrixGeometry geometry;
+    int width = 12;
+    int height = 12;
+    int pixel_count = 144;
+    float currentTPS = 0;
+    std::vector<uint8_t> dirty;
+    std::vector<uint8_t> dirty_rows;
+    std::vector<uint32_t> exported;
+    std::vector<uint32_t> back;
+    Layer layers[LAYER_COUNT];
+    // colors of an indexed layer while composing
+    std::vector<uint32_t> expanded;
+    std::vector<Sprite> sprites;
+    int active_layer = LAYER_GAME;
+    std::vector<uint32_t> front[2];
+    int front_index = 0;
+    std::atomic<uint32_t*> front_buffer{nullptr};
+    std::atomic<uint32_t> frame_id{0};
+    std::vector<int> strip_map;
+    std::vector<int> matrix_map;
+    bool any_dirty = false;
+    // output correction, see set_brightness
+    int brightness = 255;
+    float gamma = 1;
+    int correction[3] = {255, 255, 255};
+    uint8_t lut[3][256] = {};
+    bool lut_identity = true;
+    // the next present has to run, even if no layer changed
+    bool output_changed = false;
+
+    /**
+     * Rebuild the lookup table of the output correction.
+     */
+    void update_lut()
+    {
+        lut_identity = brightness == 255 && gamma == 1 &&
+            correction[0] == 255 && correction[1] == 255 && correction[2] == 255;
+        for (int channel = 0; channel < 3; channel++)
         {
-            for (int i = 0; i < width; i++)
+            const float scale = static_cast<float>(brightness * correction[channel]) / (255.0f * 255.0f);
+            for (int v = 0; v < 256; v++)
             {
-                this->line(x + i, y, x + i, y + height, color);
+                const float linear = std::pow(static_cast<float>(v) / 255.0f, gamma);
+                lut[channel][v] = static_cast<uint8_t>(std::lround(linear * scale * 255.0f));
             }
-            for (int i = 0; i < height; i++)
+        }
+        output_changed = true;
+    }
+
+    /**
+     * Check and reset the dirty flag of a pixel.
+     * @return true if the pixel differs from the last exported color
+     */
+    bool is_changed(int n, const uint32_t* pixels)
+    {
+        if (!dirty[n])
+        {
+            return false;
+        }
+        dirty[n] = 0;
+        return pixels[n] != exported[n];
+    }
+
+    /**
+     * Get the active layer for drawing. Marks the layer as changed.
+     */
+    Layer& canvas()
+    {
+        Layer& layer = layers[active_layer];
+        layer.dirty = true;
+        layer.empty = false;
+        return layer;
+    }
+
+    /**
+     * Flatten all visible layers into the back buffer.
+     */
+    void compose()
+    {
+        const Layer& background = layers[LAYER_BACKGROUND];
+        if (background.visible && !background.empty && background.opacity == 255)
+        {
+            const uint32_t* colors = layer_colors(background, false);
+            std::copy(colors, colors + pixel_count, back.begin());
+        }
+        else
+        {
+            std::fill(back.begin(), back.end(), 0);
+            if (background.visible && !background.empty)
+            {
+                blend_layer(background, layer_colors(background, false), false);
+            }
+        }
+
+        for (int i = LAYER_BACKGROUND + 1; i < LAYER_COUNT; i++)
+        {
+            const Layer& layer = layers[i];
+            if (layer.visible && !layer.empty && layer.opacity > 0)
             {
-                this->line(x, y + i, x + width, y + i, color);
+                blend_layer(layer, layer_colors(layer, true), true);
             }
         }
-        this->line(x, y, x + width, y, color);
-        this->line(x, y + height, x + width, y + height, color);
-        this->line(x, y, x, y + height, color);
-        this->line(x + width, y, x + width, y + height, color);
     }
 
     /**
-     * Draw a rectangle at a specific position with a specific color.
-     * @param x x-coordinate of the position
-     * @param y y-coordinate of the position
-     * @param width width of the rectangle
-     * @param height height of the rectangle
-     * @param r red value of the rectangle
-     * @param g green value of the rectangle
-     * @param b blue value of the rectangle
-     * @param filled (optional) if true, the rectangle will be filled
+     * Get the colors of a layer. Indexed layers are resolved through their palette.
+     * @param transparent if true, index 0 is resolved to off
      */
-    void rect(int x, int y, int width, int height, int r, int g, int b, bool filled = false)
+    const uint32_t* layer_colors(const Layer& layer, bool transparent)
     {
-        this->rect(x, y, width, height, Color(r, g, b), filled);
+        if (!layer.index_bits)
+        {
+            return layer.pixels.data();
+        }
+        uint32_t palette[256];
+        std::copy(layer.palette.begin(), layer.palette.end(), palette);
+        if (transparent)
+        {
+            palette[0] = 0;
+        }
+        for (int i = 0; i < pixel_count; i++)
+        {
+            expanded[i] = palette[layer.indices[i]];
+        }
+        return expanded.data();
     }
 
     /**
-     * Draw a circle at a specific position with a specific color.
-     * @param x x-coordinate of the position
-     * @param y y-coordinate of the position
-     * @param radius radius of the circle
-     * @param color color of the circle
-     * @param filled (optional) if true, the circle will be filled
-     * @param u (optional) number of steps for the circle (smaller numbers means higher fidelity)
+     * Blend the colors of a layer onto the back buffer.
+     * @param transparent if true, pixels which are off are skipped
      */
-    void circle(int x, int y, int radius, uint32_t color, bool filled = true, int u = 2)
+    void blend_layer(const Layer& layer, const uint32_t* src, bool transparent)
     {
-        for (int i = 0; i < 360; i += u)
+        uint32_t* dst = back.data();
+        const uint32_t a = layer.opacity;
+
+        if (layer.blend == BLEND_NORMAL && a == 255)
+        {
+            for (int i = 0; i < pixel_count; i++)
+            {
+                if (src[i] != 0 || !transparent)
+                {
+                    dst[i] = src[i];
+                }
+            }
+            return;
+        }
+
+        for (int i = 0; i < pixel_count; i++)
         {
-            if (i == 0)
+            if (src[i] == 0 && transparent)
+            {
                 continue;
-            this->set(floor(cos(i) * radius + x), floor(sin(i) * radius + y), color, true);
-            if (filled)
+            }
+            uint32_t result = 0;
+            for (int shift = 0; shift <= 16; shift += 8)
             {
-                // TODO
+                const uint32_t s = src[i] >> shift & 0xFF;
+                const uint32_t d = dst[i] >> shift & 0xFF;
+                uint32_t c;
+                switch (layer.blend)
+                {
+                case BLEND_ADD:
+                    c = std::min<uint32_t>(255, d + s * a / 255);
+                    break;
+                case BLEND_MULTIPLY:
+                    c = (d * (255 - a) + d * s / 255 * a) / 255;
+                    break;
+                case BLEND_NORMAL:
+                default:
+                    c = (d * (255 - a) + s * a) / 255;
+                    break;
+                }
+                result |= c << shift;
             }
+            dst[i] = result;
         }
     }
 
     /**
-     * Draw a circle at a specific position with a specific color.
-     * @param x x-coordinate of the position
-     * @param y y-coordinate of the position
-     * @param radius radius of the circle
-     * @param r red value of the circle
-     * @param g green value of the circle
-     * @param b blue value of the circle
-     * @param filled (optional) if true, the circle will be filled
-     * @param u (optional) number of steps for the circle (smaller numbers means higher fidelity)
+     * Draw a glyph into a buffer in matrix order, clipped to the buffer.
+     * put is called with the position of every pixel of the glyph.
      */
-
-    void circle(int x, int y, int radius, int r, int g, int b, bool filled = false, int u = 2)
+    template <typename F>
+    static void glyph(int target_width, int target_height, int x, int y, uint16_t glyph, F put)
     {
-        this->circle(x, y, radius, Color(r, g, b), filled, u);
+        for (int row = 0; row < font::GLYPH_HEIGHT; row++)
+        {
+            const int ty = y + row;
+            if (ty < 0 || ty >= target_height)
+            {
+                continue;
+            }
+            for (int col = 0; col < font::GLYPH_WIDTH; col++)
+            {
+                const int tx = x + col;
+                if (tx >= 0 && tx < target_width && font::glyph_pixel(glyph, col, row))
+                {
+                    put(ty * target_width + tx);
+                }
+            }
+        }
     }
 
     /**
-     * Create a color from red, green and blue values.
-     * Useful for most helper functions.
-     * @param r red value
-     * @param g green value
-     * @param b blue value
+     * Draw the opaque spans of a sprite with its left edge at left,
+     * clipped to the columns [min_x, max_x) and the matrix.
      */
-
-    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b)
+    void sprite_columns(Layer& target, const Sprite& sprite, int left, int y, int min_x, int max_x)
     {
-        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+        for (int row = 0; row < sprite.height; row++)
+        {
+            const int ty = y + row;
+            if (ty < 0 || ty >= this->height)
+            {
+                continue;
+            }
+            const uint32_t* line = sprite.pixels.data() + row * sprite.width;
+            const int out = ty * this->width;
+            for (uint32_t s = sprite.row_spans[row]; s < sprite.row_spans[row + 1]; s += 2)
+            {
+                const int first = std::max<int>(sprite.spans[s], min_x - left);
+                const int last = std::min<int>(sprite.spans[s] + sprite.spans[s + 1], max_x - left);
+                if (first < last)
+                {
+                    target.copy(out + left + first, line + first, last - first);
+                }
+            }
+        }
     }
 
     /**
-     * Set the Ticks per Second for each application.
-     * This will adjust the frequency of the game_loop function.
-     * The draw calls won't be affected.
-     * @param tps Ticks per second
+     * Move the pixels of a layer, see scroll.
      */
-    void set_tps(float tps)
+    template <typename T>
+    void scroll_pixels(std::vector<T>& pixels, int dx, int dy, bool wrap, T fill)
     {
-        if (tps > 200)
+        const auto begin = pixels.begin();
+        const auto end = pixels.end();
+        if (wrap)
         {
-            tps = 200;
+            dx = (dx % width + width) % width;
+            dy = (dy % height + height) % height;
+        }
+        else if (std::abs(dx) >= width || std::abs(dy) >= height)
+        {
+            std::fill(begin, end, fill);
+            return;
         }
 
-        if (tps < 0)
+        // rows are stored bottom up, moving up means moving to higher indices
+        const int rows = std::abs(dy) * width;
+        if (wrap && dy != 0)
         {
-            tps = 0;
+            std::rotate(begin, end - rows, end);
+        }
+        else if (dy > 0)
+        {
+            std::copy_backward(begin, end - rows, end);
+            std::fill(begin, begin + rows, fill);
+        }
+        else if (dy < 0)
+        {
+            std::copy(begin + rows, end, begin);
+            std::fill(end - rows, end, fill);
         }
 
-        this->currentTPS = tps;
+        if (dx == 0)
+        {
+            return;
+        }
+        const int shift = std::abs(dx);
+        for (auto row = begin; row != end; row += width)
+        {
+            if (wrap)
+            {
+                std::rotate(row, row + width - dx, row + width);
+            }
+            else if (dx > 0)
+            {
+                std::copy_backward(row, row + width - shift, row + width);
+                std::fill(row, row + shift, fill);
+            }
+            else
+            {
+                std::copy(row + shift, row + width, row);
+                std::fill(row + width - shift, row + width, fill);
+            }
+        }
     }
 
     /**
-     * Get the ticks per second for
-     * the current animation
-     * @return Ticks per Second
+     * Swap the rows and columns of a square layer.
      */
+    template <typename T>
+    void transpose_pixels(std::vector<T>& pixels)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = y + 1; x < width; x++)
+            {
+                std::swap(pixels[y * width + x], pixels[x * width + y]);
+            }
+        }
+    }
 
-    float get_current_tps()
+    /**
+     * Mirror the pixels of a layer, see mirror.
+     */
+    template <typename T>
+    void mirror_pixels(std::vector<T>& pixels, int flip)
     {
-        return currentTPS;
+        if (flip & FLIP_X)
+        {
+            for (auto row = pixels.begin(); row != pixels.end(); row += width)
+            {
+                std::reverse(row, row + width);
+            }
+        }
+        if (flip & FLIP_Y)
+        {
+            for (int y = 0; y < height / 2; y++)
+            {
+                std::swap_ranges(pixels.begin() + y * width, pixels.begin() + (y + 1) * width,
+                                 pixels.begin() + (height - 1 - y) * width);
+            }
+        }
     }
 
-private:
-    uint32_t* pixels;
-    bool inverse = false;
-    float currentTPS = 0;
+    /**
+     * Plot the eight symmetric points of a circle octant.
+     */
+    void circle_points(int x, int y, int dx, int dy, uint32_t color, bool inside)
+    {
+        Layer& target = canvas();
+        const int px[8] = {x + dx, x - dx, x + dx, x - dx, x + dy, x - dy, x + dy, x - dy};
+        const int py[8] = {y + dy, y + dy, y - dy, y - dy, y + dx, y + dx, y - dx, y - dx};
+        for (int i = 0; i < 8; i++)
+        {
+            if (inside)
+            {
+                target.put(py[i] * width + px[i], color);
+            }
+            else
+            {
+                this->set(px[i], py[i], color, true);
+            }
+        }
+    }
 
-    int calculate_strip_pixel(int x, int y)
+    /**
+     * Calculate the position of a pixel on the led strip. Only used to build the strip map.
+     */
+    int map_strip_pixel(int x, int y)
     {
-        return x +(11-y)*12;
+        // rows are counted from the top, the panel chain starts top left
+        const int row = height - 1 - y;
+        const int panel = (row / geometry.panel_height) * geometry.tiles_x + x / geometry.panel_width;
+        const int offset = panel * geometry.panel_width * geometry.panel_height;
+        const int w = geometry.panel_width;
+        const int h = geometry.panel_height;
+        x %= w;
+        y = h - 1 - row % h;
+
         if (inverse)
         {
-            x = 11 - x; //FOR MATRIX BUILD ON 11.01.2025
+            x = w - 1 - x; //FOR MATRIX BUILD ON 11.01.2025
         }
 
-        if (x < 0 || x > 11 || y < 0 || y > 11)
+        switch (geometry.wiring)
         {
-            std::cout << "Out of range" << std::endl;
-            return -1;
+        case WIRING_SERPENTINE:
+            {
+                const int r = h - 1 - y;
+                return offset + r * w + (r % 2 == 0 ? x : w - 1 - x);
+            }
+        case WIRING_COLUMN_SERPENTINE:
+            return offset + x * h + (x % 2 == 0 ? y : h - 1 - y);
+        case WIRING_MIRRORED:
+            return offset + (w - 1 - x) + (h - 1 - y) * w;
+        case WIRING_ROTATED:
+            return offset + (w - 1 - x) + y * w;
+        case WIRING_ROW_MAJOR:
+        default:
+            return offset + x + (h - 1 - y) * w;
         }
-
-        int bottom_row = floor((x + 1) / 2) * 23 + floor(x / 2);
-        int height_correction = -((x % 2) * 2 - 1) * y;
-        return bottom_row + height_correction;
     }
 
     unsigned count_digits(unsigned i)
@@ -0,0 +1,373 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "wrench.h"
+#include "Runtime.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "MatrixManager.h"
+#include "ControlManager.h"
+#include "WrenchWrapper.h"
+#include "FrameCodec.h"
+
+
+static int size = 0;
+static unsigned char* outBytes = nullptr;
+static WRState* w = nullptr;
+static WRContext* wc = nullptr;
+static MatrixManager *mm = nullptr;
+static ControlManager *cm = nullptr;
+static Clock *runtime_clock = nullptr;
+static ControlElements *elements = nullptr;
+static std::vector<uint32_t> changes;
+static FrameEncoder* encoder = nullptr;
+static FrameDecoder* decoder = nullptr;
+static int encoded_length = 0;
+static bool auto_present = true;
+// survives programs, so replaying the same animations stays cheap
+static AnimationCache animation_cache;
+
+// entry points of the running program, resolved once in init
+static WRFunction* init_function = nullptr;
+static WRFunction* draw_function = nullptr;
+static WRFunction* game_loop_function = nullptr;
+static WRFunction* on_event_function = nullptr;
+static WRFunction* on_animation_end_function = nullptr;
+// animations which finished in the last frame, reused to avoid allocations
+static std::vector<int> finished_animations;
+// the animations drew on the animation layer in the last frame
+static bool animations_drawn = false;
+
+static WRFunction* resolve_function(const char* name, bool required)
+{
+    WRFunction* function = wr_getFunction(wc, name);
+    if (!function && required)
+    {
+        throw std::runtime_error(std::string("Program does not define the function ") + name);
+    }
+    return function;
+}
+
+static WRValue* call_function(WRFunction* function, const char* name, const WRValue* argv = nullptr, int argn = 0)
+{
+    if (!function)
+    {
+        throw std::runtime_error(std::string("Program is not initialized, can't call ") + name);
+    }
+    return wr_callFunction(wc, function, argv, argn);
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void setup()
+{
+    configure_matrix(12, 12, 1, 1, WIRING_ROW_MAJOR);
+    runtime_clock = new Clock();
+    cm = new ControlManager([]()
+    {
+
+    }, runtime_clock);
+    cm->set_animation_cache(&animation_cache);
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE int configure_matrix(int panel_width, int panel_height, int tiles_x, int tiles_y,
+                                                 int wiring)
+{
+    if (w || panel_width <= 0 || panel_height <= 0 || tiles_x <= 0 || tiles_y <= 0 ||
+        wiring < WIRING_ROW_MAJOR || wiring > WIRING_ROTATED)
+    {
+        return 0;
+    }
+
+    MatrixGeometry geometry;
+    geometry.panel_width = panel_width;
+    geometry.panel_height = panel_height;
+    geometry.tiles_x = tiles_x;
+    geometry.tiles_y = tiles_y;
+    geometry.wiring = static_cast<MatrixWiring>(wiring);
+
+    delete mm;
+    mm = new MatrixManager(false, geometry);
+    delete encoder;
+    encoder = new FrameEncoder(mm->get_pixel_count());
+    delete decoder;
+    decoder = new FrameDecoder(mm->get_pixel_count());
+    encoded_length = 0;
+    return 1;
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE int get_width()
+{
+    return mm->get_width();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE int get_height()
+{
+    return mm->get_height();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE int get_led_count()
+{
+    return mm->get_pixel_count();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE int getSize() {
+    return size;
+}
+
+
+EXTERN EMSCRIPTEN_KEEPALIVE uint8_t* compile(char* p) {
+
+
+
+    size_t length = strlen(p);
+
+    int outLen = 0;
+    const int err = wr_compile(p, length, &outBytes, &outLen); // compile it
+    size = outLen;
+    //return bytes
+    return outBytes;
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE const uint32_t* get_leds()
+{
+
+    return mm->get_leds();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void present()
+{
+    mm->present();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void set_brightness(int brightness)
+{
+    mm->set_brightness(brightness);
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void set_gamma(float gamma)
+{
+    mm->set_gamma(gamma);
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void set_color_correction(int r, int g, int b)
+{
+    mm->set_color_correction(r, g, b);
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void set_auto_present(int enabled)
+{
+    auto_present = enabled != 0;
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE uint32_t get_frame_id()
+{
+    return mm->get_frame_id();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE uint32_t* get_changes()
+{
+    mm->collect_changes(changes);
+    return changes.data();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE int get_changes_length()
+{
+    return static_cast<int>(changes.size());
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE const uint8_t* encode_frame()
+{
+    const std::vector<uint8_t>& encoded = encoder->encode(mm->get_leds());
+    encoded_length = static_cast<int>(encoded.size());
+    return encoded.data();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE int get_encoded_length()
+{
+    return encoded_length;
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void reset_encoder()
+{
+    encoder->reset();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE int decode_frame(const uint8_t* data, int length)
+{
+    return decoder->decode(data, length) ? 1 : 0;
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE const uint32_t* get_decoded_frame()
+{
+    return decoder->get_frame();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void init()
+{
+    w = wr_newState();
+    wr_loadMathLib(w);
+    wr_loadStringLib(w);
+    wr_loadContainerLib(w);
+    delete elements;
+    elements = new ControlElements(cm, mm);
+    wrench_wrapper::register_wrench_functions(w,elements);
+    wc = wr_run(w, outBytes, size);
+    if (!wc)
+    {
+        throw std::runtime_error("Error running program");
+    }
+    init_function = resolve_function("init", true);
+    draw_function = resolve_function("draw", true);
+    game_loop_function = resolve_function("game_loop", true);
+    on_event_function = resolve_function("on_event", false);
+    on_animation_end_function = resolve_function("on_animation_end", false);
+    wr_setAllocatedMemoryGCHint(w,1000);
+    mm->set_tps(30);
+    cm->stop_animation();
+    runtime_clock->reset_rates();
+    mm->reset_layers();
+    animations_drawn = false;
+    mm->clear_sprites();
+    WRValue* result = call_function(init_function, "init");
+    if (!result)
+    {
+        throw std::runtime_error("Error calling function");
+    }
+    if (auto_present)
+    {
+        mm->present();
+    }
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void destroy()
+{
+    wr_destroyState(w);
+    w = nullptr;
+    delete elements;
+    elements = nullptr;
+    wc = nullptr;
+    init_function = nullptr;
+    draw_function = nullptr;
+    game_loop_function = nullptr;
+    on_event_function = nullptr;
+    on_animation_end_function = nullptr;
+    cm->stop_animation();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void draw()
+{
+    runtime_clock->begin_frame();
+    WRValue* result = call_function(draw_function, "draw");
+
+    if (cm->is_animation_running())
+    {
+        // all animations draw on their own layer above the program, it is drawn from scratch every frame
+        const int program_layer = mm->get_layer();
+        mm->set_layer(LAYER_ANIMATION);
+        mm->clear();
+        finished_animations.clear();
+        cm->__internal_step_animations(mm, finished_animations);
+        mm->set_layer(program_layer);
+        animations_drawn = true;
+
+        // the program may start new animations from the callback
+        for (const int id : finished_animations)
+        {
+            if (on_animation_end_function)
+            {
+                WRValue val;
+                wr_makeInt(&val, id);
+                wr_callFunction(wc, on_animation_end_function, &val, 1);
+            }
+        }
+    }
+    else if (animations_drawn)
+    {
+        // the animations finished or were stopped, without animations the layer belongs to the program
+        mm->clear_layer(LAYER_ANIMATION);
+        animations_drawn = false;
+    }
+
+    if (auto_present)
+    {
+        mm->present();
+    }
+    runtime_clock->end_frame();
+
+    if (!result)
+    {
+        throw std::runtime_error("Error calling function");
+    }
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void sendEvent(int id)
+{
+    if (!on_event_function)
+    {
+        // on_event is optional, programs without input simply ignore events
+        return;
+    }
+    WRValue val;
+    wr_makeInt(&val, id);
+    wr_callFunction(wc, on_event_function, &val, 1);
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void game_loop()
+{
+    runtime_clock->begin_tick();
+    WRValue* result = call_function(game_loop_function, "game_loop");
+    if (!result)
+    {
+        throw std::runtime_error("Error calling function");
+    }
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE float get_tps()
+{
+    return mm->get_current_tps();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE float get_measured_tps()
+{
+    return runtime_clock->get_tps();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE float get_fps()
+{
+    return runtime_clock->get_fps();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE uint8_t get_controls()
+{
+    return cm->get_controls();
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE const uint8_t* get_status()
+{
+    return reinterpret_cast<const uint8_t*>(cm->get_status_pointer()->data());
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE uint8_t get_status_length()
+{
+       return strlen(cm->get_status().c_str());
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void set_animation_cache(int max_bytes, int fps)
+{
+    animation_cache.configure(static_cast<size_t>(std::max(max_bytes, 0)), fps);
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE int get_animation_cache_size()
+{
+    return static_cast<int>(animation_cache.get_size());
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void set_virtual_clock(int enabled)
+{
+    runtime_clock->set_virtual(enabled != 0);
+}
+
+EXTERN EMSCRIPTEN_KEEPALIVE void advance_clock(double ms)
+{
+    runtime_clock->advance(ms);
+}
@@ -0,0 +1,255 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+#else
+#define EXTERN
+#endif
+
+/**
+ * The exported runtime API. In the browser build these functions are kept alive
+ * for the JavaScript side, in the native build they are a plain C API used by the
+ * headless host tools.
+ */
+
+/**
+ * Allocate the led buffer and the managers. Has to be called once before anything else.
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void setup();
+
+/**
+ * Change the size of the matrix. The matrix consists of tiles_x * tiles_y panels,
+ * chained row by row starting top left. Can only be called while no program is running.
+ * Replaces the led buffer, pointers from get_leds have to be fetched again.
+ * @param panel_width width of a single panel
+ * @param panel_height height of a single panel
+ * @param tiles_x amount of panels next to each other
+ * @param tiles_y amount of panels on top of each other
+ * @param wiring how the leds of a panel are chained: 0 row major, 1 serpentine,
+ *               2 column serpentine, 3 mirrored, 4 rotated
+ * @return 1 if the matrix was changed
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE int configure_matrix(int panel_width, int panel_height, int tiles_x, int tiles_y,
+                                                 int wiring);
+
+/**
+ * Get the width of the matrix in pixels.
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE int get_width();
+
+/**
+ * Get the height of the matrix in pixels.
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE int get_height();
+
+/**
+ * Get the amount of leds in the buffer returned by get_leds.
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE int get_led_count();
+
+/**
+ * Get the size of the bytecode produced by the last call to compile.
+ * @return size in bytes
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE int getSize();
+
+/**
+ * Compile a wrench program. The bytecode is kept for the next call to init.
+ * @param p zero terminated source code
+ * @return pointer to the bytecode
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE uint8_t* compile(char* p);
+
+/**
+ * Get the last presented frame in strip order. The pointer changes with every frame,
+ * so it has to be fetched again after each present. The buffer is reused two frames
+ * later, readers on another thread can detect this with get_frame_id.
+ * @return pointer to get_led_count() colors
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE const uint32_t* get_leds();
+
+/**
+ * Set the brightness of the leds. Applied to every presented frame, useful to limit
+ * the power drawn by the panels. Reset by configure_matrix.
+ * @param brightness brightness from 0 (off) to 255 (full)
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void set_brightness(int brightness);
+
+/**
+ * Set the gamma correction of the leds. Applied to every presented frame.
+ * Reset by configure_matrix.
+ * @param gamma exponent, 1 disables the correction
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void set_gamma(float gamma);
+
+/**
+ * Scale the color channels of the leds independently, for example to balance the
+ * white point of a panel. Applied to every presented frame. Reset by configure_matrix.
+ * @param r scale of the red channel from 0 to 255
+ * @param g scale of the green channel from 0 to 255
+ * @param b scale of the blue channel from 0 to 255
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void set_color_correction(int r, int g, int b);
+
+/**
+ * Publish everything drawn so far as the next frame. Called automatically at the end of
+ * init and draw unless disabled with set_auto_present.
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void present();
+
+/**
+ * Enable or disable presenting a frame automatically at the end of init and draw.
+ * Hosts which pipeline rendering and output can disable it and call present themselves.
+ * @param enabled 1 to present automatically (default), 0 to present manually
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void set_auto_present(int enabled);
+
+/**
+ * Get the amount of presented frames. Compare it before and after copying the buffer
+ * from get_leds, if it increased by more than one the copy may be torn.
+ * @return frame id
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE uint32_t get_frame_id();
+
+/**
+ * Get the pixels of the presented frames which changed since the last call, instead of
+ * the complete led buffer.
+ * The result is a list of spans of consecutive pixels in strip order:
+ * [span count, (start index, length, length colors)...]
+ * The buffer stays valid until the next call.
+ * @return pointer to the changes, see get_changes_length for the amount of words
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE uint32_t* get_changes();
+
+/**
+ * Get the amount of 32 bit words returned by the last call to get_changes.
+ * @return amount of words
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE int get_changes_length();
+
+/**
+ * Encode the last presented frame for the transport to remote panels, see FrameCodec.h.
+ * Only the difference to the previously encoded frame is stored, the first frame after
+ * setup, configure_matrix or reset_encoder is a key frame.
+ * The buffer stays valid until the next call.
+ * @return pointer to the encoded frame, see get_encoded_length for the amount of bytes
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE const uint8_t* encode_frame();
+
+/**
+ * Get the amount of bytes returned by the last call to encode_frame.
+ * @return amount of bytes
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE int get_encoded_length();
+
+/**
+ * Make the next call to encode_frame produce a key frame, for example when a receiver connects.
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void reset_encoder();
+
+/**
+ * Apply a frame produced by encode_frame to the decoded frame. Used on the receiving side,
+ * the decoder has the size of the configured matrix.
+ * @param data the encoded frame
+ * @param length size of the encoded frame in bytes
+ * @return 1 if the frame was valid
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE int decode_frame(const uint8_t* data, int length);
+
+/**
+ * Get the frame built by decode_frame in strip order.
+ * @return pointer to get_led_count() colors
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE const uint32_t* get_decoded_frame();
+
+/**
+ * Run the last compiled program and call its init function.
+ * The functions init, draw and game_loop are required, on_event is optional.
+ * Throws if the program can't be run or a required function is missing.
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void init();
+
+/**
+ * Destroy the wrench state of the running program.
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void destroy();
+
+/**
+ * Call the draw function of the program and step the running animation.
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void draw();
+
+/**
+ * Send an event to the on_event function of the program.
+ * Ignored if the program does not define on_event.
+ * @param id id of the event
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void sendEvent(int id);
+
+/**
+ * Call the game_loop function of the program.
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void game_loop();
+
+/**
+ * Get the ticks per second requested by the program.
+ * Hosts call game_loop at this rate.
+ * @return ticks per second
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE float get_tps();
+
+/**
+ * Get the ticks per second the host actually achieved, measured over the last second.
+ * @return ticks per second
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE float get_measured_tps();
+
+/**
+ * Get the frames per second the host actually achieved, measured over the last second
+ * (a shorter window above 255 frames per second).
+ * @return frames per second
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE float get_fps();
+
+EXTERN EMSCRIPTEN_KEEPALIVE uint8_t get_controls();
+
+EXTERN EMSCRIPTEN_KEEPALIVE const uint8_t* get_status();
+
+EXTERN EMSCRIPTEN_KEEPALIVE uint8_t get_status_length();
+
+/**
+ * Pre-render deterministic animations like the splash and replay their frames.
+ * The least recently used animations are evicted to stay below the memory limit.
+ * Replayed animations match live ones when the frame rate is the same. An animation started
+ * between frames, for example in game_loop, starts with the next frame instead.
+ * @param max_bytes memory limit of the cache, 0 disables it
+ * @param fps frame rate the animations are rendered at
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void set_animation_cache(int max_bytes, int fps);
+
+/**
+ * Get the memory used by the animation cache.
+ * @return size in bytes
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE int get_animation_cache_size();
+
+/**
+ * Switch the runtime between the system clock and a virtual clock.
+ * The virtual clock only moves on advance_clock, which allows to simulate
+ * a program faster than real time.
+ * @param enabled 1 to use the virtual clock, 0 for the system clock
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void set_virtual_clock(int enabled);
+
+/**
+ * Move the virtual clock forward.
+ * @param ms time in ms
+ */
+EXTERN EMSCRIPTEN_KEEPALIVE void advance_clock(double ms);
@@ -0,0 +1,227 @@
+#pragma once
+#include "Animation.h"
+#include "AnimationCache.h"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+/**
+ * Runs any number of animations at the same time. Every animation is a track with its
+ * own start time, duration and keep time. A track can be delayed and can wait for
+ * another track to finish, so animations can be stacked and chained.
+ * The timeline owns the animations and deletes them once they are finished or stopped.
+ * With a cache, cacheable animations are rendered once and replayed from their clip.
+ * A replayed track starts at the first frame at or after its start time.
+ * Animations may start and stop tracks while they are stepped, for example from a script.
+ * Such changes are applied once the step is over.
+ */
+class Timeline
+{
+public:
+    /**
+     * Add an animation to the timeline.
+     * @param animation Animation, owned by the timeline from now on
+     * @param now current time in ms
+     * @param duration_ms duration in ms
+     * @param keep_time (optional) time in ms the animation keeps running after the duration
+     * @param delay_ms (optional) time in ms until the animation starts
+     * @param after (optional) id of a track which has to finish before the delay starts, -1 for none
+     * @return id of the track
+     */
+    int add(Animation* animation, double now, int duration_ms, int keep_time = 0, int delay_ms = 0,
+            int after = -1)
+    {
+        Track track;
+        track.id = next_id++;
+        track.animation.reset(animation);
+        track.duration = static_cast<float>(std::max(duration_ms, 1));
+        track.keep = static_cast<float>(std::max(keep_time, 0));
+        track.delay = std::max(delay_ms, 0);
+        track.after = after;
+        if (after < 0 || !this->is_running(after))
+        {
+            track.start = now + track.delay;
+            track.scheduled = true;
+        }
+        // tracks must not move while they are stepped
+        std::vector<Track>& target = stepping ? pending : tracks;
+        target.push_back(std::move(track));
+        return target.back().id;
+    }
+
+    /**
+     * Stop a track before it is finished. Tracks waiting for it start with the next step.
+     * @param id id of the track
+     */
+    void stop(int id)
+    {
+        const auto matches = [id](const Track& track)
+        {
+            return track.id == id;
+        };
+        pending.erase(std::remove_if(pending.begin(), pending.end(), matches), pending.end());
+        if (stepping)
+        {
+            // the animation may be the one which is running, it is deleted after the step
+            for (Track& track : tracks)
+            {
+                track.stopped |= matches(track);
+            }
+            return;
+        }
+        tracks.erase(std::remove_if(tracks.begin(), tracks.end(), matches), tracks.end());
+    }
+
+    /**
+     * Stop all tracks.
+     */
+    void stop_all()
+    {
+        pending.clear();
+        if (stepping)
+        {
+            for (Track& track : tracks)
+            {
+                track.stopped = true;
+            }
+            return;
+        }
+        tracks.clear();
+    }
+
+    /**
+     * Check if a track is running or waiting to start.
+     * @param id id of the track
+     * @return bool
+     */
+    bool is_running(int id)
+    {
+        const auto matches = [id](const Track& track)
+        {
+            return track.id == id && !track.stopped;
+        };
+        return std::any_of(tracks.begin(), tracks.end(), matches) ||
+            std::any_of(pending.begin(), pending.end(), matches);
+    }
+
+    /**
+     * Check if no track is running or waiting to start.
+     * @return bool
+     */
+    bool empty()
+    {
+        return pending.empty() && std::all_of(tracks.begin(), tracks.end(), [](const Track& track)
+        {
+            return track.stopped;
+        });
+    }
+
+    /**
+     * Replay cacheable animations from a cache, see AnimationCache.
+     * @param cache cache to use, nullptr to always run the animations
+     */
+    void set_cache(AnimationCache* cache)
+    {
+        this->cache = cache;
+    }
+
+    /**
+     * Run all tracks which have started for the current frame and remove the finished ones.
+     * @param mm MatrixManager to draw on
+     * @param now current time in ms
+     * @param finished receives the ids of the tracks which finished in this step
+     */
+    void step(MatrixManager* mm, double now, std::vector<int>& finished)
+    {
+        stepping = true;
+        // tracks added while stepping wait in pending, so the count and the references stay valid
+        const size_t count = tracks.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            Track& track = tracks[i];
+            if (track.stopped)
+            {
+                continue;
+            }
+            if (!track.scheduled)
+            {
+                if (this->is_running(track.after))
+                {
+                    continue;
+                }
+                track.start = now + track.delay;
+                track.scheduled = true;
+            }
+            if (now >= track.start && !track.cache_checked)
+            {
+                // clips are rendered on the empty layer, before any track draws on it
+                track.cache_checked = true;
+                if (cache && cache->is_enabled())
+                {
+                    if (auto clip = cache->get(track.animation.get(), track.duration, track.keep, mm))
+                    {
+                        track.player = std::make_unique<ClipPlayer>(std::move(clip));
+                        // clip frames are rendered at frame times, a track started between frames
+                        // begins with this frame instead of showing a frame which is too old
+                        track.start = now;
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            Track& track = tracks[i];
+            if (track.stopped || !track.scheduled || now < track.start)
+            {
+                continue;
+            }
+
+            const float time_running = static_cast<float>(now - track.start);
+            const bool done = track.player
+                                  ? track.player->play(time_running, mm)
+                                  : track.animation->run(time_running / track.duration, mm);
+            // a track stopped by its own animation doesn't count as finished
+            if (done && !track.stopped && time_running / (track.duration + track.keep) > 1)
+            {
+                track.stopped = true;
+                finished.push_back(track.id);
+            }
+        }
+        stepping = false;
+
+        tracks.erase(std::remove_if(tracks.begin(), tracks.end(), [](const Track& track)
+        {
+            return track.stopped;
+        }), tracks.end());
+        std::move(pending.begin(), pending.end(), std::back_inserter(tracks));
+        pending.clear();
+    }
+
+private:
+    struct Track
+    {
+        int id = 0;
+        std::unique_ptr<Animation> animation;
+        float duration = 1;
+        float keep = 0;
+        int delay = 0;
+        int after = -1;
+        double start = 0;
+        // replays the animation from the cache
+        std::unique_ptr<ClipPlayer> player;
+        // false while waiting for the track given by after
+        bool scheduled = false;
+        bool cache_checked = false;
+        // finished or stopped, removed at the end of the step
+        bool stopped = false;
+    };
+
+    std::vector<Track> tracks;
+    // tracks added during a step
+    std::vector<Track> pending;
+    bool stepping = false;
+    AnimationCache* cache = nullptr;
+    int next_id = 1;
+};
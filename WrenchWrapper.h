@@ -5,6 +5,8 @@
 #ifndef WRENCHWRAPPER_H
 #define WRENCHWRAPPER_H
 #include "animations/Splash.h"
+#include "animations/KeyframeAnimation.h"
+#include "animations/ScriptAnimation.h"
 
 #include "wrench.h"
 #include "ControlManager.h"
@@ -13,9 +15,60 @@ struct ControlElements
 {
     ControlManager* cm;
     MatrixManager* mm;
+    // reused by draw_batch, so submitting commands doesn't allocate every frame
+    std::vector<int32_t> commands;
+    // reused by run_animation_keyframes to read the keyframes
+    std::vector<int32_t> keyframes;
+    // holds the raw arrays handed out by framebuffer
+    WRValue raw_arrays;
+    // the raw array of each layer, an int until framebuffer exposed the layer
+    WRValue framebuffers[LAYER_COUNT];
+
+    ControlElements(ControlManager* cm, MatrixManager* mm) : cm(cm), mm(mm)
+    {
+        // WRValue doesn't initialize itself
+        raw_arrays.init();
+        for (WRValue& framebuffer : framebuffers)
+        {
+            framebuffer.init();
+        }
+    }
+
+    ~ControlElements()
+    {
+        if (raw_arrays.xtype == WR_EX_HASH_TABLE)
+        {
+            wr_destroyContainer(&raw_arrays);
+        }
+    }
 };
 namespace wrench_wrapper
 {
+    /**
+     * Copy the elements of a wrench array as integers.
+     * @param limit (optional) copy at most this many elements, -1 for all
+     * @return false if the value is not an array
+     */
+    template <typename T>
+    bool read_array(WRContext* c, const WRValue& value, std::vector<T>& out, int limit = -1)
+    {
+        int length = 0;
+        if (!value.isWrenchArray(&length))
+        {
+            return false;
+        }
+        if (limit >= 0)
+        {
+            length = std::min(length, limit);
+        }
+        out.resize(length);
+        for (int i = 0; i < length; i++)
+        {
+            out[i] = static_cast<T>(const_cast<WRValue&>(value).indexArray(c, i, false)->asInt());
+        }
+        return true;
+    }
+
     inline void print(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
     {
         char buf[128];
@@ -51,6 +104,36 @@ namespace wrench_wrapper
         wr_makeFloat(&retVal, ce->mm->get_current_tps());
     }
 
+    inline void get_measured_tps(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        auto* ce = static_cast<ControlElements*>(usr);
+        wr_makeFloat(&retVal, ce->cm->__internal_get_clock()->get_tps());
+    }
+
+    inline void get_fps(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        auto* ce = static_cast<ControlElements*>(usr);
+        wr_makeFloat(&retVal, ce->cm->__internal_get_clock()->get_fps());
+    }
+
+    inline void get_frame_delta(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        auto* ce = static_cast<ControlElements*>(usr);
+        wr_makeFloat(&retVal, static_cast<float>(ce->cm->__internal_get_clock()->frame_delta_ms()));
+    }
+
+    inline void get_width(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        auto* ce = static_cast<ControlElements*>(usr);
+        wr_makeInt(&retVal, ce->mm->get_width());
+    }
+
+    inline void get_height(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        auto* ce = static_cast<ControlElements*>(usr);
+        wr_makeInt(&retVal, ce->mm->get_height());
+    }
+
     inline void set_tps(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
     {
         if (argn != 1) return;
@@ -83,24 +166,44 @@ namespace wrench_wrapper
     inline void is_animation_running(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
     {
         auto ce = static_cast<ControlElements*>(usr);
+        if (argn == 1)
+        {
+            wr_makeInt(&retVal, ce->cm->is_animation_running(argv[0].asInt()));
+            return;
+        }
         wr_makeInt(&retVal, ce->cm->is_animation_running());
 
     }
 
-    /*void run_animation(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr) {
-        if (argn != 2) return;
-        ControlElements* ce = static_cast<ControlElements*>(usr);
-        Animation* anim = new Animation(); // Assuming Animation has a default constructor
-        ce->cm->run_animation(anim, argv[0].asInt(), argv[1].asInt());
-        wr_makeInt(&retVal, 1);
+    /**
+     * Run a function of the program as an animation, see ScriptAnimation.
+     * Arguments: function name, duration, keep time, [delay], [after]
+     */
+    inline void run_animation(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn < 3 || argn > 5) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        char name[64];
+        WRFunction* function = wr_getFunction(c, argv[0].asString(name, sizeof(name)));
+        if (!function) return;
+        const int delay = argn > 3 ? argv[3].asInt() : 0;
+        const int after = argn > 4 ? argv[4].asInt() : -1;
+        wr_makeInt(&retVal, ce->cm->run_animation(new ScriptAnimation(c, function), argv[1].asInt(), argv[2].asInt(),
+                                                  delay, after));
     }
-    */
 
 
     inline void stop_animation(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
     {
         auto ce = static_cast<ControlElements*>(usr);
-        ce->cm->stop_animation();
+        if (argn == 1)
+        {
+            ce->cm->stop_animation(argv[0].asInt());
+        }
+        else
+        {
+            ce->cm->stop_animation();
+        }
         wr_makeInt(&retVal, 1);
     }
 
@@ -143,11 +246,27 @@ namespace wrench_wrapper
         wr_makeInt(&retVal, 1);
     }
 
+    inline void draw_hline(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 4) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->hline(argv[0].asInt(), argv[1].asInt(), argv[2].asInt(), argv[3].asInt());
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void draw_vline(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 4) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->vline(argv[0].asInt(), argv[1].asInt(), argv[2].asInt(), argv[3].asInt());
+        wr_makeInt(&retVal, 1);
+    }
+
     inline void draw_rect_filled(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
     {
         if (argn != 5) return;
         auto ce = static_cast<ControlElements*>(usr);
-        ce->mm->rect(argv[0].asInt(), argv[1].asInt(), argv[2].asInt(), argv[3].asInt(), argv[4].asInt(),true); //make fillable controlable
+        ce->mm->fill_rect(argv[0].asInt(), argv[1].asInt(), argv[2].asInt(), argv[3].asInt(), argv[4].asInt());
         wr_makeInt(&retVal, 1);
     }
 
@@ -161,9 +280,10 @@ namespace wrench_wrapper
 
     inline void draw_circle(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
     {
-        if (argn != 4) return;
+        if (argn != 4 && argn != 5) return;
         auto ce = static_cast<ControlElements*>(usr);
-        ce->mm->circle(argv[0].asInt(), argv[1].asInt(), argv[2].asInt(), argv[3].asInt());
+        const bool filled = argn == 5 && argv[4].asInt() != 0;
+        ce->mm->circle(argv[0].asInt(), argv[1].asInt(), argv[2].asInt(), argv[3].asInt(), filled);
         wr_makeInt(&retVal, 1);
     }
 
@@ -175,14 +295,294 @@ namespace wrench_wrapper
         wr_makeInt(&retVal, 1);
     }
 
+    inline void set_brightness(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 1) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->set_brightness(argv[0].asInt());
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void get_brightness(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        auto ce = static_cast<ControlElements*>(usr);
+        wr_makeInt(&retVal, ce->mm->get_brightness());
+    }
+
+    inline void set_gamma(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 1) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->set_gamma(argv[0].asFloat());
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void scroll(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn < 2 || argn > 4) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->scroll(argv[0].asInt(), argv[1].asInt(), argn < 3 || argv[2].asInt() != 0,
+                       argn == 4 ? argv[3].asInt() : 0);
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void rotate(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn > 1) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->rotate(argn == 0 || argv[0].asInt() != 0);
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void mirror(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 1) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->mirror(argv[0].asInt());
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void draw_batch(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 1 && argn != 2) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        if (!read_array(c, argv[0], ce->commands, argn == 2 ? std::max(argv[1].asInt(), 0) : -1)) return;
+        wr_makeInt(&retVal, ce->mm->execute(ce->commands.data(), static_cast<int>(ce->commands.size())));
+    }
+
+    /**
+     * Hand out the pixels of a layer as a raw byte array, see MatrixManager::expose_layer.
+     * The script indexes the array directly, without a callback per pixel.
+     */
+    inline void framebuffer(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn > 1) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        const int layer = argn == 1 ? argv[0].asInt() : ce->mm->get_layer();
+        int size = 0;
+        uint8_t* pixels = ce->mm->expose_layer(layer, size);
+        if (!pixels) return;
+        // the pixels of an exposed layer don't move, so each layer is only added to the container once
+        WRValue& framebuffer = ce->framebuffers[layer];
+        if (framebuffer.type == WR_INT)
+        {
+            if (ce->raw_arrays.xtype != WR_EX_HASH_TABLE)
+            {
+                wr_makeContainer(&ce->raw_arrays);
+            }
+            const std::string name = "layer" + std::to_string(layer);
+            wr_addArrayToContainer(&ce->raw_arrays, name.c_str(), reinterpret_cast<char*>(pixels), size);
+            framebuffer = *wr_getValueFromContainer(ce->raw_arrays, name.c_str());
+        }
+        retVal = framebuffer;
+    }
+
+    //sprites
+    inline void add_sprite(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 3 && argn != 4) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        const int width = argv[0].asInt();
+        const int height = argv[1].asInt();
+        std::vector<uint32_t> pixels;
+        if (!MatrixManager::is_sprite_size_valid(width, height) || !read_array(c, argv[2], pixels) ||
+            static_cast<long long>(pixels.size()) < static_cast<long long>(width) * height)
+        {
+            wr_makeInt(&retVal, -1);
+            return;
+        }
+        wr_makeInt(&retVal, ce->mm->add_sprite(width, height, pixels.data(), argn == 4 ? argv[3].asInt() : 0));
+    }
+
+    inline void add_indexed_sprite(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 4 && argn != 5) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        const int width = argv[0].asInt();
+        const int height = argv[1].asInt();
+        std::vector<int32_t> values;
+        std::vector<uint32_t> palette;
+        if (!MatrixManager::is_sprite_size_valid(width, height) || !read_array(c, argv[2], values) ||
+            static_cast<long long>(values.size()) < static_cast<long long>(width) * height ||
+            !read_array(c, argv[3], palette))
+        {
+            wr_makeInt(&retVal, -1);
+            return;
+        }
+        // indices above 255 would be truncated to a different color
+        std::vector<uint8_t> indices(values.size());
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            if (values[i] < 0 || values[i] > UINT8_MAX)
+            {
+                wr_makeInt(&retVal, -1);
+                return;
+            }
+            indices[i] = static_cast<uint8_t>(values[i]);
+        }
+        wr_makeInt(&retVal, ce->mm->add_sprite(width, height, indices.data(), palette.data(),
+                                               static_cast<int>(palette.size()), argn == 5 ? argv[4].asInt() : -1));
+    }
+
+    inline void blit(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 3 && argn != 4) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->blit(argv[0].asInt(), argv[1].asInt(), argv[2].asInt(), argn == 4 ? argv[3].asInt() : FLIP_NONE);
+        wr_makeInt(&retVal, 1);
+    }
+
+    //text
+    inline void draw_text(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 4 && argn != 5) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        WRValue::MallocStrScoped text(argv[2]);
+        if (!text) return;
+        ce->mm->text(argv[0].asInt(), argv[1].asInt(), std::string(static_cast<const char*>(text)), argv[3].asInt(),
+                     argn == 5 ? argv[4].asInt() : 1);
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void text_width(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 1 && argn != 2) return;
+        WRValue::MallocStrScoped text(argv[0]);
+        if (!text) return;
+        wr_makeInt(&retVal, MatrixManager::text_width(std::string(static_cast<const char*>(text)), argn == 2 ? argv[1].asInt() : 1));
+    }
+
+    inline void text_strip(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn < 2 || argn > 4) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        WRValue::MallocStrScoped text(argv[0]);
+        if (!text) return;
+        wr_makeInt(&retVal, ce->mm->text_strip(std::string(static_cast<const char*>(text)), argv[1].asInt(),
+                                               argn >= 3 ? argv[2].asInt() : 1, argn == 4 ? argv[3].asInt() : -1));
+    }
+
+    inline void draw_marquee(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 5 && argn != 6) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->marquee(argv[0].asInt(), argv[1].asInt(), argv[2].asInt(), argv[3].asInt(), argv[4].asInt(),
+                        argn == 6 ? argv[5].asInt() : 3);
+        wr_makeInt(&retVal, 1);
+    }
+
+    //layers
+    inline void set_layer(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 1) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->set_layer(argv[0].asInt());
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void clear_layer(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 1) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->clear_layer(argv[0].asInt());
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void layer_blend(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 2 && argn != 3) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->set_layer_blend(argv[0].asInt(), argv[1].asInt(), argn == 3 ? argv[2].asInt() : BLEND_NORMAL);
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void layer_visible(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 2) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->set_layer_visible(argv[0].asInt(), argv[1].asInt() > 0);
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void layer_indexed(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 2) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->set_layer_indexed(argv[0].asInt(), argv[1].asInt());
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void set_palette(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 3) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->set_palette(argv[0].asInt(), argv[1].asInt(), argv[2].asInt());
+        wr_makeInt(&retVal, 1);
+    }
+
+    inline void cycle_palette(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 3 && argn != 4) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        ce->mm->cycle_palette(argv[0].asInt(), argv[1].asInt(), argv[2].asInt(), argn == 4 ? argv[3].asInt() : 1);
+        wr_makeInt(&retVal, 1);
+    }
+
     //animations
     inline void run_animation_splash(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
     {
-        if (argn != 6) return;
+        if (argn < 6 || argn > 8) return;
         auto ce = static_cast<ControlElements*>(usr);
         auto anim = new Splash(argv[0].asInt(), argv[1].asInt(), argv[2].asInt(), argv[3].asInt() > 0);
-        ce->cm->run_animation(anim, argv[4].asInt(), argv[5].asInt());
-        wr_makeInt(&retVal, 1);
+        const int delay = argn > 6 ? argv[6].asInt() : 0;
+        const int after = argn > 7 ? argv[7].asInt() : -1;
+        wr_makeInt(&retVal, ce->cm->run_animation(anim, argv[4].asInt(), argv[5].asInt(), delay, after));
+    }
+
+    /**
+     * Run a keyframed shape. The keyframes are a flat array with six entries per keyframe:
+     * time in thousandths of the duration, x, y, size, color and the ease towards the next keyframe.
+     * Arguments: shape, filled, keyframes, duration, keep time, [delay], [after]
+     */
+    inline void run_animation_keyframes(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn < 5 || argn > 7) return;
+        auto ce = static_cast<ControlElements*>(usr);
+        if (!read_array(c, argv[2], ce->keyframes)) return;
+        auto anim = new KeyframeAnimation(argv[0].asInt(), argv[1].asInt() > 0);
+        for (size_t i = 0; i + 6 <= ce->keyframes.size(); i += 6)
+        {
+            const int32_t* key = &ce->keyframes[i];
+            anim->add(static_cast<float>(key[0]) / 1000, key[1], key[2], key[3], key[4], key[5]);
+        }
+        const int delay = argn > 5 ? argv[5].asInt() : 0;
+        const int after = argn > 6 ? argv[6].asInt() : -1;
+        wr_makeInt(&retVal, ce->cm->run_animation(anim, argv[3].asInt(), argv[4].asInt(), delay, after));
+    }
+
+    inline void ease(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 2 && argn != 3) return;
+        wr_makeFloat(&retVal, easing::apply(argv[0].asInt(), argv[1].asFloat(), argn == 3 ? argv[2].asInt() : 4));
+    }
+
+    inline void rgb(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 3) return;
+        wr_makeInt(&retVal, MatrixManager::clamped_color(argv[0].asInt(), argv[1].asInt(), argv[2].asInt()));
+    }
+
+    inline void lerp_color(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 3) return;
+        const int amount = static_cast<int>(argv[2].asFloat() * 256);
+        wr_makeInt(&retVal, MatrixManager::lerp_color(argv[0].asInt(), argv[1].asInt(), amount));
+    }
+
+    inline void hsv(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
+    {
+        if (argn != 3) return;
+        wr_makeInt(&retVal, MatrixManager::hsv(argv[0].asInt(), argv[1].asInt(), argv[2].asInt()));
     }
 
     inline void wrench_random(WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr)
@@ -203,9 +603,16 @@ namespace wrench_wrapper
         wr_registerFunction(w, "set_controls", wrench_wrapper::set_controls, ce);
         wr_registerFunction(w, "get_current_tps", wrench_wrapper::get_current_tps, ce);
         wr_registerFunction(w, "set_tps", wrench_wrapper::set_tps, ce);
+        // same names and meanings as the C API, get_tps is the requested rate
+        wr_registerFunction(w, "get_tps", wrench_wrapper::get_current_tps, ce);
+        wr_registerFunction(w, "get_measured_tps", wrench_wrapper::get_measured_tps, ce);
+        wr_registerFunction(w, "get_fps", wrench_wrapper::get_fps, ce);
+        wr_registerFunction(w, "get_frame_delta", wrench_wrapper::get_frame_delta, ce);
+        wr_registerFunction(w, "get_width", wrench_wrapper::get_width, ce);
+        wr_registerFunction(w, "get_height", wrench_wrapper::get_height, ce);
         wr_registerFunction(w, "reset_controls", wrench_wrapper::reset_controls, ce);
         wr_registerFunction(w, "is_animation_running", wrench_wrapper::is_animation_running, ce);
-        // wr_registerFunction(w, "run_animation", wrench_wrapper::run_animation, ce);
+        wr_registerFunction(w, "run_animation", wrench_wrapper::run_animation, ce);
         wr_registerFunction(w, "stop_animation", wrench_wrapper::stop_animation, ce);
 
         wr_registerFunction(w, "set", wrench_wrapper::set_pixel, ce);
@@ -213,16 +620,89 @@ namespace wrench_wrapper
         wr_registerFunction(w, "fill", wrench_wrapper::fill_matrix, ce);
         wr_registerFunction(w, "clear", wrench_wrapper::clear_matrix, ce);
         wr_registerFunction(w, "line", wrench_wrapper::draw_line, ce);
+        wr_registerFunction(w, "hline", wrench_wrapper::draw_hline, ce);
+        wr_registerFunction(w, "vline", wrench_wrapper::draw_vline, ce);
         wr_registerFunction(w, "rect", wrench_wrapper::draw_rect, ce);
         wr_registerFunction(w, "rect_filled", wrench_wrapper::draw_rect_filled, ce);
         wr_registerFunction(w, "circle", wrench_wrapper::draw_circle, ce);
         wr_registerFunction(w, "number", wrench_wrapper::draw_number, ce);
+        wr_registerFunction(w, "scroll", wrench_wrapper::scroll, ce);
+        wr_registerFunction(w, "rotate", wrench_wrapper::rotate, ce);
+        wr_registerFunction(w, "mirror", wrench_wrapper::mirror, ce);
+        wr_registerFunction(w, "draw_batch", wrench_wrapper::draw_batch, ce);
+        wr_registerFunction(w, "framebuffer", wrench_wrapper::framebuffer, ce);
+        wr_registerLibraryConstant(w, "op::set", OP_SET);
+        wr_registerLibraryConstant(w, "op::line", OP_LINE);
+        wr_registerLibraryConstant(w, "op::hline", OP_HLINE);
+        wr_registerLibraryConstant(w, "op::vline", OP_VLINE);
+        wr_registerLibraryConstant(w, "op::rect", OP_RECT);
+        wr_registerLibraryConstant(w, "op::rect_filled", OP_RECT_FILLED);
+        wr_registerLibraryConstant(w, "op::circle", OP_CIRCLE);
+        wr_registerLibraryConstant(w, "op::circle_filled", OP_CIRCLE_FILLED);
+        wr_registerLibraryConstant(w, "op::number", OP_NUMBER);
+        wr_registerLibraryConstant(w, "op::fill", OP_FILL);
+        wr_registerLibraryConstant(w, "op::clear", OP_CLEAR);
+        wr_registerLibraryConstant(w, "op::blit", OP_BLIT);
+        wr_registerLibraryConstant(w, "op::layer", OP_LAYER);
+        wr_registerFunction(w, "set_brightness", wrench_wrapper::set_brightness, ce);
+        wr_registerFunction(w, "get_brightness", wrench_wrapper::get_brightness, ce);
+        wr_registerFunction(w, "set_gamma", wrench_wrapper::set_gamma, ce);
+
+        //sprites
+        wr_registerFunction(w, "sprite", wrench_wrapper::add_sprite, ce);
+        wr_registerFunction(w, "sprite_indexed", wrench_wrapper::add_indexed_sprite, ce);
+        wr_registerFunction(w, "blit", wrench_wrapper::blit, ce);
+        wr_registerLibraryConstant(w, "flip::none", FLIP_NONE);
+        wr_registerLibraryConstant(w, "flip::x", FLIP_X);
+        wr_registerLibraryConstant(w, "flip::y", FLIP_Y);
+
+        //text
+        wr_registerFunction(w, "text", wrench_wrapper::draw_text, ce);
+        wr_registerFunction(w, "text_width", wrench_wrapper::text_width, ce);
+        wr_registerFunction(w, "text_strip", wrench_wrapper::text_strip, ce);
+        wr_registerFunction(w, "marquee", wrench_wrapper::draw_marquee, ce);
+
+        //layers
+        wr_registerFunction(w, "set_layer", wrench_wrapper::set_layer, ce);
+        wr_registerFunction(w, "clear_layer", wrench_wrapper::clear_layer, ce);
+        wr_registerFunction(w, "layer_blend", wrench_wrapper::layer_blend, ce);
+        wr_registerFunction(w, "layer_visible", wrench_wrapper::layer_visible, ce);
+        wr_registerLibraryConstant(w, "layer::background", LAYER_BACKGROUND);
+        wr_registerLibraryConstant(w, "layer::game", LAYER_GAME);
+        wr_registerLibraryConstant(w, "layer::ui", LAYER_UI);
+        wr_registerLibraryConstant(w, "layer::animation", LAYER_ANIMATION);
+        wr_registerLibraryConstant(w, "blend::normal", BLEND_NORMAL);
+        wr_registerLibraryConstant(w, "blend::add", BLEND_ADD);
+        wr_registerLibraryConstant(w, "blend::multiply", BLEND_MULTIPLY);
+        wr_registerFunction(w, "layer_indexed", wrench_wrapper::layer_indexed, ce);
+        wr_registerFunction(w, "palette", wrench_wrapper::set_palette, ce);
+        wr_registerFunction(w, "palette_cycle", wrench_wrapper::cycle_palette, ce);
 
         //animations
         wr_registerFunction(w, "run_animation_splash", wrench_wrapper::run_animation_splash, ce);
+        wr_registerFunction(w, "run_animation_keyframes", wrench_wrapper::run_animation_keyframes, ce);
+        wr_registerLibraryConstant(w, "shape::pixel", SHAPE_PIXEL);
+        wr_registerLibraryConstant(w, "shape::circle", SHAPE_CIRCLE);
+        wr_registerLibraryConstant(w, "shape::rect", SHAPE_RECT);
+        wr_registerFunction(w, "ease", wrench_wrapper::ease, ce);
+        wr_registerLibraryConstant(w, "ease::linear", easing::EASE_LINEAR);
+        wr_registerLibraryConstant(w, "ease::quad_in", easing::EASE_QUAD_IN);
+        wr_registerLibraryConstant(w, "ease::quad_out", easing::EASE_QUAD_OUT);
+        wr_registerLibraryConstant(w, "ease::quad_in_out", easing::EASE_QUAD_IN_OUT);
+        wr_registerLibraryConstant(w, "ease::cubic_in", easing::EASE_CUBIC_IN);
+        wr_registerLibraryConstant(w, "ease::cubic_out", easing::EASE_CUBIC_OUT);
+        wr_registerLibraryConstant(w, "ease::cubic_in_out", easing::EASE_CUBIC_IN_OUT);
+        wr_registerLibraryConstant(w, "ease::elastic_in", easing::EASE_ELASTIC_IN);
+        wr_registerLibraryConstant(w, "ease::elastic_out", easing::EASE_ELASTIC_OUT);
+        wr_registerLibraryConstant(w, "ease::bounce_in", easing::EASE_BOUNCE_IN);
+        wr_registerLibraryConstant(w, "ease::bounce_out", easing::EASE_BOUNCE_OUT);
+        wr_registerLibraryConstant(w, "ease::steps", easing::EASE_STEPS);
 
         //utils
         wr_registerFunction(w, "random", wrench_wrapper::wrench_random, ce);
+        wr_registerFunction(w, "rgb", wrench_wrapper::rgb, ce);
+        wr_registerFunction(w, "lerp_color", wrench_wrapper::lerp_color, ce);
+        wr_registerFunction(w, "hsv", wrench_wrapper::hsv, ce);
     }
 }
 #endif //WRENCHWRAPPER_H
@@ -0,0 +1,92 @@
+#pragma once
+#include "../Animation.h"
+#include "../Keyframes.h"
+
+enum KeyframeShape
+{
+    SHAPE_PIXEL = 0,
+    SHAPE_CIRCLE,
+    SHAPE_RECT,
+};
+
+/**
+ * Draws a shape whose position, size and color follow keyframes.
+ * The animation is declared once, the runtime interpolates every frame.
+ * The position is the center of the shape, the size is the radius of a circle
+ * and half the side of a rectangle. Tracks without keyframes stay at 0.
+ */
+class KeyframeAnimation : public Animation
+{
+public:
+    KeyframeAnimation(int shape, bool filled = true)
+    {
+        this->shape = shape;
+        this->filled = filled;
+    }
+
+    /**
+     * Add a keyframe to all tracks at once.
+     * @param time point in time from 0 to 1
+     * @param x x-coordinate of the center
+     * @param y y-coordinate of the center
+     * @param size radius or half side
+     * @param color color
+     * @param ease (optional) easing towards the next keyframe, see easing::Ease
+     */
+    void add(float time, int x, int y, int size, uint32_t color, int ease = easing::EASE_LINEAR)
+    {
+        this->x.add(time, x, ease);
+        this->y.add(time, y, ease);
+        this->size.add(time, size, ease);
+        this->color.add(time, static_cast<int32_t>(color), ease);
+    }
+
+    Keyframes& get_x()
+    {
+        return x;
+    }
+
+    Keyframes& get_y()
+    {
+        return y;
+    }
+
+    Keyframes& get_size()
+    {
+        return size;
+    }
+
+    Keyframes& get_color()
+    {
+        return color;
+    }
+
+    bool run(float progress, MatrixManager *mm)
+    {
+        const int cx = x.value(progress);
+        const int cy = y.value(progress);
+        const int s = std::max(size.value(progress), 0);
+        const uint32_t c = color.color(progress);
+        switch (shape)
+        {
+        case SHAPE_CIRCLE:
+            mm->circle(cx, cy, s, c, filled);
+            break;
+        case SHAPE_RECT:
+            mm->rect(cx - s, cy - s, s * 2 + 1, s * 2 + 1, c, filled);
+            break;
+        default:
+            mm->set(cx, cy, c, true);
+            break;
+        }
+        return progress >= 1;
+    }
+
+private:
+    int shape;
+    bool filled;
+    Keyframes x;
+    Keyframes y;
+    Keyframes size;
+    Keyframes color;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include "../Animation.h"
+#include "../wrench.h"
+
+/**
+ * Runs an animation defined by the program as a wrench function. The function is
+ * called once per frame with the progress as its only argument and draws on the
+ * animation layer with the usual functions. Like every animation it runs for its
+ * duration and keep time, the return value of the function is ignored.
+ * The function is resolved once, every frame calls it through the cached pointer.
+ */
+class ScriptAnimation : public Animation
+{
+public:
+    ScriptAnimation(WRContext* context, WRFunction* function)
+    {
+        this->context = context;
+        this->function = function;
+    }
+
+    bool run(float progress, MatrixManager *mm)
+    {
+        WRValue argument;
+        wr_makeFloat(&argument, progress);
+        if (!wr_callFunction(context, function, &argument, 1))
+        {
+            // the function failed, finish as soon as possible
+            return true;
+        }
+        return progress >= 1;
+    }
+
+private:
+    WRContext* context;
+    WRFunction* function;
+};
@@ -9,36 +9,43 @@ public:
         this->y = y;
         this->color = color;
         this->filled = filled;
-
-        int max_radius = longestDistanceToBorder(x,y);
-        this->max_radius = max_radius;
-        // get longest distance to border 0,0 11,11
     }
     bool run(float progress, MatrixManager *mm)
     {
-        int currentSteps = max_radius * progress;
-        if(!filled) {
-            mm->clear();
+        if (max_radius < 0)
+        {
+            // get longest distance to the border of the matrix
+            max_radius = longestDistanceToBorder(x, y, mm->get_width(), mm->get_height());
         }
-        mm->circle(x, y, currentSteps, color,false,1);
+        int currentSteps = max_radius * progress;
+        // the animation layer is cleared every frame, so a filled splash draws the whole disk
+        mm->circle(x, y, currentSteps, color, filled);
        // Serial.println(progress);
 
         return progress > 1;
     }
 
+    unsigned long long cache_key() const
+    {
+        // 'S' keeps the keys apart from other animations
+        return (static_cast<unsigned long long>('S') << 56) ^ (static_cast<unsigned long long>(x & 0x7FF) << 45) ^
+            (static_cast<unsigned long long>(y & 0x7FF) << 34) ^ (static_cast<unsigned long long>(filled) << 33) ^
+            (color & 0xFFFFFF);
+    }
+
 
 private:
     int x, y;
     uint32_t color;
-    int max_radius = 0;
+    int max_radius = -1;
     bool filled = false;
-    int longestDistanceToBorder(int x, int y)
+    int longestDistanceToBorder(int x, int y, int width, int height)
     {
         // Calculate the distances to each border
         int distanceToTop = y;
-        int distanceToBottom = 11 - y;
+        int distanceToBottom = height - 1 - y;
         int distanceToLeft = x;
-        int distanceToRight = 11 - x;
+        int distanceToRight = width - 1 - x;
 
         // Return the maximum of these distances
         return std::max({distanceToTop, distanceToBottom, distanceToLeft, distanceToRight})+2;
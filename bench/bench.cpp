@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <vector>
+#include "wrench.h"
+#include "../host/HostUtils.h"
+
+/**
+ * Frame time benchmark for the draw/game_loop pipeline.
+ * Every program of the corpus is run for a number of frames. The latency of each call
+ * to game_loop and draw is recorded together with the bytes allocated during the call,
+ * both by the wrench VM and by the runtime itself. The results are written as JSON.
+ *
+ * Usage: WrenchBench [--frames n] [--warmup n] [--matrix WxH] [--out file.json] [program.wr...]
+ * Without programs the corpus in bench/programs is used.
+ */
+static size_t allocated_bytes = 0;
+
+static void* counting_malloc(size_t size)
+{
+    allocated_bytes += size;
+    return malloc(size);
+}
+
+static void counting_free(void* ptr)
+{
+    free(ptr);
+}
+
+void* operator new(size_t size)
+{
+    allocated_bytes += size;
+    if (void* ptr = malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+struct Samples
+{
+    std::vector<double> us;
+    size_t bytes = 0;
+};
+
+struct Result
+{
+    std::string program;
+    const char* function;
+    size_t calls;
+    double mean_us;
+    double p50_us;
+    double p99_us;
+    double max_us;
+    double bytes_per_call;
+};
+
+template <typename F>
+static void measure(Samples& samples, F f)
+{
+    const size_t bytes_before = allocated_bytes;
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    samples.bytes += allocated_bytes - bytes_before;
+    samples.us.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+}
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    const size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static Result summarize(const std::string& program, const char* function, Samples& samples)
+{
+    std::sort(samples.us.begin(), samples.us.end());
+    double total = 0;
+    for (double us : samples.us)
+    {
+        total += us;
+    }
+    const double calls = static_cast<double>(std::max<size_t>(samples.us.size(), 1));
+    return Result{
+        program, function, samples.us.size(), total / calls,
+        percentile(samples.us, 0.50), percentile(samples.us, 0.99),
+        samples.us.empty() ? 0 : samples.us.back(),
+        static_cast<double>(samples.bytes) / calls
+    };
+}
+
+static bool run_program(const std::string& path, int warmup, int frames, std::vector<Result>& results)
+{
+    if (!host_utils::compile_file(path.c_str()))
+    {
+        return false;
+    }
+    const std::string name = std::filesystem::path(path).stem().string();
+
+    Samples loop_samples;
+    Samples draw_samples;
+    loop_samples.us.reserve(frames);
+    draw_samples.us.reserve(frames);
+
+    set_virtual_clock(1);
+    init();
+    for (int i = 0; i < warmup; i++)
+    {
+        advance_clock(1000.0 / 60);
+        game_loop();
+        draw();
+    }
+    for (int i = 0; i < frames; i++)
+    {
+        advance_clock(1000.0 / 60);
+        measure(loop_samples, game_loop);
+        measure(draw_samples, draw);
+    }
+    destroy();
+
+    results.push_back(summarize(name, "game_loop", loop_samples));
+    results.push_back(summarize(name, "draw", draw_samples));
+    return true;
+}
+
+static void write_json(FILE* out, const std::vector<Result>& results, int frames)
+{
+    fprintf(out, "{\n  \"frames\": %d,\n  \"width\": %d,\n  \"height\": %d,\n  \"results\": [\n",
+            frames, get_width(), get_height());
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        fprintf(out,
+                "    {\"program\": \"%s\", \"function\": \"%s\", \"calls\": %zu, \"mean_us\": %.3f, "
+                "\"p50_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f, \"bytes_per_call\": %.1f}%s\n",
+                r.program.c_str(), r.function, r.calls, r.mean_us, r.p50_us, r.p99_us, r.max_us,
+                r.bytes_per_call, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+int main(int argc, char** argv)
+{
+    int frames = 2000;
+    int warmup = 100;
+    int panel_width = 12;
+    int panel_height = 12;
+    const char* out_path = nullptr;
+    std::vector<std::string> programs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            frames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+        {
+            warmup = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--matrix") == 0 && i + 1 < argc)
+        {
+            if (!host_utils::parse_size(argv[++i], panel_width, panel_height))
+            {
+                fprintf(stderr, "invalid matrix size '%s'\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            out_path = argv[++i];
+        }
+        else
+        {
+            programs.emplace_back(argv[i]);
+        }
+    }
+
+    if (programs.empty())
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(WRENCH_BENCH_PROGRAMS_DIR))
+        {
+            if (entry.path().extension() == ".wr")
+            {
+                programs.push_back(entry.path().string());
+            }
+        }
+        std::sort(programs.begin(), programs.end());
+    }
+
+    wr_setGlobalAllocator(counting_malloc, counting_free);
+    setup();
+    configure_matrix(panel_width, panel_height, 1, 1, 0);
+
+    std::vector<Result> results;
+    for (const std::string& program : programs)
+    {
+        if (!run_program(program, warmup, frames, results))
+        {
+            return 1;
+        }
+    }
+
+    for (const Result& r : results)
+    {
+        fprintf(stderr, "%-12s %-10s p50=%8.2fus p99=%8.2fus max=%8.2fus alloc=%8.1fB/call\n",
+                r.program.c_str(), r.function, r.p50_us, r.p99_us, r.max_us, r.bytes_per_call);
+    }
+
+    FILE* out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out)
+    {
+        fprintf(stderr, "could not open '%s'\n", out_path);
+        return 1;
+    }
+    write_json(out, results, frames);
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return 0;
+}
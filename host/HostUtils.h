@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "../Runtime.h"
+
+/**
+ * Helpers shared by the native host tools.
+ */
+namespace host_utils
+{
+    inline bool read_file(const char* path, std::string& out)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        out = buffer.str();
+        return true;
+    }
+
+    /**
+     * Compile a wrench program from a file with the runtime.
+     * @return false if the file could not be read or compiled
+     */
+    inline bool compile_file(const char* path)
+    {
+        std::string source;
+        if (!read_file(path, source))
+        {
+            fprintf(stderr, "could not read '%s'\n", path);
+            return false;
+        }
+        compile(source.data());
+        if (getSize() <= 0)
+        {
+            fprintf(stderr, "could not compile '%s'\n", path);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Parse a size in the form WxH.
+     */
+    inline bool parse_size(const char* text, int& width, int& height)
+    {
+        return sscanf(text, "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+    }
+
+    /**
+     * Print the led buffer in strip order, one line per matrix width.
+     */
+    inline void print_leds()
+    {
+        const uint32_t* leds = get_leds();
+        const int width = get_width();
+        for (int i = 0; i < get_led_count(); i++)
+        {
+            printf("%06X%c", leds[i] & 0xFFFFFF, (i + 1) % width == 0 ? '\n' : ' ');
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include "HostUtils.h"
+
+/**
+ * Headless runner for the native build.
+ * Compiles a wrench program, runs init and then calls game_loop and draw for the
+ * given amount of frames. The final led buffer and status are printed afterwards.
+ * Usage: WrenchHost <program.wr> [frames]
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <program.wr> [frames]\n", argv[0]);
+        return 1;
+    }
+    const int frames = argc > 2 ? atoi(argv[2]) : 1;
+
+    setup();
+    if (!host_utils::compile_file(argv[1]))
+    {
+        return 1;
+    }
+
+    try
+    {
+        init();
+        for (int i = 0; i < frames; i++)
+        {
+            game_loop();
+            draw();
+        }
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "program failed: %s\n", e.what());
+        return 1;
+    }
+
+    host_utils::print_leds();
+    printf("status: %.*s\n", get_status_length(), reinterpret_cast<const char*>(get_status()));
+    printf("controls: 0x%02X\n", get_controls());
+
+    destroy();
+    return 0;
+}
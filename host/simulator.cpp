@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "HostUtils.h"
+
+/**
+ * Headless simulator for the native build.
+ * Runs a wrench program against the virtual clock of the runtime. game_loop is called
+ * with the ticks per second requested by the program, draw with the given frame rate
+ * and events are sent at fixed simulated times. Since the clock only moves in simulated
+ * time, many seconds of a program run in a fraction of a real second.
+ *
+ * Usage: WrenchSim <program.wr> [--seconds s] [--fps n] [--event ms:id]... [--budget-us us] [--matrix WxH] [--tiles XxY] [--wiring n] [--codec] [--cache bytes] [--dump]
+ *
+ * If a budget is given, the simulator exits with 2 if any call to
+ * game_loop or draw took longer than the budget in real time.
+ * With --codec every frame is sent through the frame encoder and decoder, the simulator
+ * reports the transport size and exits with 3 if a decoded frame differs.
+ * --cache enables the animation cache with the given memory limit, rendered at the frame rate.
+ */
+struct SimulatedEvent
+{
+    double time_ms;
+    int id;
+};
+
+struct CallStats
+{
+    long long calls = 0;
+    double total_us = 0;
+    double max_us = 0;
+    long long over_budget = 0;
+
+    void add(double us, double budget_us)
+    {
+        calls++;
+        total_us += us;
+        max_us = std::max(max_us, us);
+        if (budget_us > 0 && us > budget_us)
+        {
+            over_budget++;
+        }
+    }
+
+    void print(const char* name)
+    {
+        printf("%s: calls=%lld avg_us=%.2f max_us=%.2f over_budget=%lld\n", name, calls,
+               calls > 0 ? total_us / calls : 0.0, max_us, over_budget);
+    }
+};
+
+template <typename F>
+static double measure_us(F f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s <program.wr> [--seconds s] [--fps n] [--event ms:id]... [--budget-us us] [--matrix WxH] [--tiles XxY] [--wiring n] [--codec] [--cache bytes] [--dump]\n",
+            name);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    double seconds = 60;
+    double fps = 60;
+    double budget_us = 0;
+    bool dump = false;
+    bool codec = false;
+    int cache_bytes = 0;
+    int panel_width = 12;
+    int panel_height = 12;
+    int tiles_x = 1;
+    int tiles_y = 1;
+    int wiring = 0;
+    std::vector<SimulatedEvent> events;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+        {
+            seconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+        {
+            fps = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--budget-us") == 0 && i + 1 < argc)
+        {
+            budget_us = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--event") == 0 && i + 1 < argc)
+        {
+            SimulatedEvent event{};
+            if (sscanf(argv[++i], "%lf:%d", &event.time_ms, &event.id) != 2)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            events.push_back(event);
+        }
+        else if (strcmp(argv[i], "--matrix") == 0 && i + 1 < argc)
+        {
+            if (!host_utils::parse_size(argv[++i], panel_width, panel_height))
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--tiles") == 0 && i + 1 < argc)
+        {
+            if (!host_utils::parse_size(argv[++i], tiles_x, tiles_y))
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--wiring") == 0 && i + 1 < argc)
+        {
+            wiring = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--codec") == 0)
+        {
+            codec = true;
+        }
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+        {
+            cache_bytes = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--dump") == 0)
+        {
+            dump = true;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (fps <= 0 || seconds <= 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::sort(events.begin(), events.end(), [](const SimulatedEvent& a, const SimulatedEvent& b)
+    {
+        return a.time_ms < b.time_ms;
+    });
+
+    setup();
+    if (!configure_matrix(panel_width, panel_height, tiles_x, tiles_y, wiring))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!host_utils::compile_file(argv[1]))
+    {
+        return 1;
+    }
+
+    set_virtual_clock(1);
+    set_animation_cache(cache_bytes, static_cast<int>(fps));
+
+    CallStats loop_stats;
+    CallStats draw_stats;
+    CallStats event_stats;
+    long long encoded_frames = 0;
+    long long encoded_bytes = 0;
+    long long codec_errors = 0;
+
+    const double end_ms = seconds * 1000;
+    const double frame_ms = 1000 / fps;
+    const double never = std::numeric_limits<double>::infinity();
+    double now_ms = 0;
+    double next_frame = 0;
+    double next_tick = 0;
+    size_t next_event = 0;
+
+    const auto real_start = std::chrono::steady_clock::now();
+    try
+    {
+        init();
+        while (now_ms < end_ms)
+        {
+            const float tps = get_tps();
+            if (tps <= 0)
+            {
+                next_tick = never;
+            }
+            else if (next_tick == never)
+            {
+                next_tick = now_ms;
+            }
+
+            double next = std::min(next_frame, next_tick);
+            if (next_event < events.size())
+            {
+                next = std::min(next, events[next_event].time_ms);
+            }
+            if (next >= end_ms)
+            {
+                break;
+            }
+
+            advance_clock(next - now_ms);
+            now_ms = next;
+
+            while (next_event < events.size() && events[next_event].time_ms <= now_ms)
+            {
+                const int id = events[next_event++].id;
+                event_stats.add(measure_us([id] { sendEvent(id); }), budget_us);
+            }
+            if (next_tick <= now_ms)
+            {
+                loop_stats.add(measure_us(game_loop), budget_us);
+                next_tick += 1000 / tps;
+            }
+            if (next_frame <= now_ms)
+            {
+                draw_stats.add(measure_us(draw), budget_us);
+                next_frame += frame_ms;
+                if (codec)
+                {
+                    const uint8_t* encoded = encode_frame();
+                    const int length = get_encoded_length();
+                    encoded_frames++;
+                    encoded_bytes += length;
+                    if (!decode_frame(encoded, length) ||
+                        memcmp(get_decoded_frame(), get_leds(), get_led_count() * sizeof(uint32_t)) != 0)
+                    {
+                        codec_errors++;
+                    }
+                }
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "program failed at %.1f ms: %s\n", now_ms, e.what());
+        return 1;
+    }
+    const double real_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - real_start).count();
+
+    printf("simulated_ms=%.1f real_ms=%.3f speedup=%.1fx\n", now_ms, real_ms,
+           real_ms > 0 ? now_ms / real_ms : 0.0);
+    loop_stats.print("game_loop");
+    draw_stats.print("draw");
+    event_stats.print("on_event");
+    printf("measured: tps=%.1f fps=%.1f\n", get_measured_tps(), get_fps());
+    if (codec)
+    {
+        printf("codec: frames=%lld raw_bytes_per_frame=%zu avg_bytes_per_frame=%.1f errors=%lld\n",
+               encoded_frames, get_led_count() * sizeof(uint32_t),
+               encoded_frames > 0 ? static_cast<double>(encoded_bytes) / encoded_frames : 0.0, codec_errors);
+    }
+
+    if (cache_bytes > 0)
+    {
+        printf("animation_cache: bytes=%d\n", get_animation_cache_size());
+    }
+
+    if (dump)
+    {
+        host_utils::print_leds();
+        printf("status: %.*s\n", get_status_length(), reinterpret_cast<const char*>(get_status()));
+    }
+
+    destroy();
+
+    if (loop_stats.over_budget + draw_stats.over_budget + event_stats.over_budget > 0)
+    {
+        fprintf(stderr, "frame budget of %.1f us exceeded\n", budget_us);
+        return 2;
+    }
+    if (codec_errors > 0)
+    {
+        fprintf(stderr, "%lld frames were not decoded correctly\n", codec_errors);
+        return 3;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "FrameCodec.h"
+
+/**
+ * Checks the frame decoder against well formed and malformed input.
+ * Encoded frames have to round trip, malformed frames have to be rejected without
+ * reading or writing outside of the buffers, which the sanitizer build catches.
+ * Usage: WrenchCodecTest
+ */
+static int failures = 0;
+
+static void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "failed: %s\n", what);
+        failures++;
+    }
+}
+
+static bool decode(FrameDecoder& decoder, const std::vector<uint8_t>& data)
+{
+    return decoder.decode(data.data(), static_cast<int>(data.size()));
+}
+
+int main()
+{
+    using namespace frame_codec;
+    constexpr int PIXELS = 144;
+
+    // round trip of random frames with few changes between them
+    {
+        FrameEncoder encoder(PIXELS);
+        FrameDecoder decoder(PIXELS);
+        std::vector<uint32_t> frame(PIXELS, 0);
+        srand(1);
+        bool equal = true;
+        for (int f = 0; f < 200; f++)
+        {
+            for (int k = 0; k < 20; k++)
+            {
+                frame[rand() % PIXELS] = f % 3 == 0 ? rand() % 4 * 0x404040 : rand() & 0xFFFFFF;
+            }
+            const std::vector<uint8_t> encoded = encoder.encode(frame.data());
+            equal &= decode(decoder, encoded) &&
+                std::equal(frame.begin(), frame.end(), decoder.get_frame());
+        }
+        check(equal, "frames round trip");
+    }
+
+    // malformed frames
+    {
+        FrameDecoder decoder(PIXELS);
+        check(!decoder.decode(nullptr, 0), "empty frame is rejected");
+        check(!decode(decoder, {FRAME_KEY, CODEC_LITERAL | 2, 0xFF, 0, 0, 0, 0xFF, 0}),
+              "truncated literal is rejected");
+        check(!decode(decoder, {FRAME_KEY, CODEC_SKIP | 63, CODEC_SKIP | 63, CODEC_SKIP | 63}),
+              "skip past the end is rejected");
+        check(!decode(decoder, {FRAME_KEY, CODEC_SKIP | 63, CODEC_SKIP | 63, CODEC_RUN | 63}),
+              "run past the end is rejected");
+        std::vector<uint8_t> indices(PIXELS + 2, CODEC_INDEX | 5);
+        indices[0] = FRAME_KEY;
+        check(!decode(decoder, indices), "index past the end is rejected");
+        check(decode(decoder, {FRAME_KEY, CODEC_LITERAL, 0x12, 0x34, 0x56, CODEC_RUN | 1}) &&
+              decoder.get_frame()[2] == 0x123456, "valid frame after malformed ones");
+    }
+
+    // every truncation and random garbage must not crash the decoder
+    {
+        FrameEncoder encoder(PIXELS);
+        FrameDecoder decoder(PIXELS);
+        std::vector<uint32_t> frame(PIXELS);
+        for (int i = 0; i < PIXELS; i++)
+        {
+            frame[i] = static_cast<uint32_t>(i * 0x010203);
+        }
+        const std::vector<uint8_t> encoded = encoder.encode(frame.data());
+        for (size_t length = 0; length < encoded.size(); length++)
+        {
+            decode(decoder, std::vector<uint8_t>(encoded.begin(), encoded.begin() + length));
+        }
+        srand(2);
+        std::vector<uint8_t> garbage;
+        for (int f = 0; f < 10000; f++)
+        {
+            garbage.resize(rand() % 600);
+            for (uint8_t& byte : garbage)
+            {
+                byte = static_cast<uint8_t>(rand());
+            }
+            decode(decoder, garbage);
+        }
+    }
+
+    if (failures > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}